@@ -1,272 +1,23 @@
 #include <iostream>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
-#include <deque>
-#include <memory>
+#include <vector>
 #include <chrono>
 #include <random>
-#include <vector>
-#include <rocksdb/db.h>
-
-const int BLOCK_SIZE = 4096; 
-
-struct Slab {
-    std::string id;
-    int channel;
-    std::unordered_set<int> free_blocks;
-    std::chrono::steady_clock::time_point lru;
-
-    Slab(const std::string &id, int chan, int blocks) 
-        : id(id), channel(chan), lru(std::chrono::steady_clock::now()) {
-        for(int i = 0; i < blocks; i++) free_blocks.insert(i);
-    }
-
-    int alloc() {
-        if (free_blocks.empty()) return -1;
-        auto it = free_blocks.begin();
-        int idx = *it;
-        free_blocks.erase(it);
-        lru = std::chrono::steady_clock::now();
-        return idx;
-    }
-
-    void free(int idx) {
-        free_blocks.insert(idx);
-        lru = std::chrono::steady_clock::now();
-    }
-};
-
-class RocksDBWrapper {
-    rocksdb::DB* db;
-public:
-    explicit RocksDBWrapper(const std::string& path) {
-        rocksdb::Options opts;
-        opts.create_if_missing = true;
-        opts.compression = rocksdb::kNoCompression;  // Disable compression
-        opts.disable_auto_compactions = true;  // Disable compaction
-        rocksdb::DB::Open(opts, path, &db);
-    }
-    ~RocksDBWrapper() { delete db; }
-
-    void put(const std::string &key, std::string val) {
-        if (val.size() > BLOCK_SIZE) {
-            val = val.substr(0, BLOCK_SIZE);  // Truncate
-        } else if (val.size() < BLOCK_SIZE) {
-            val.append(BLOCK_SIZE - val.size(), '\0');  // Pad
-        }
-        rocksdb::WriteOptions write_opts;
-        write_opts.disableWAL = true;  // Disable WAL to reduce overhead
-        db->Put(write_opts, key, val);
-    }
-    
-    std::string get(const std::string &key) {
-        std::string val;
-        rocksdb::Status s = db->Get(rocksdb::ReadOptions(), key, &val);
-        if (!s.ok()) {
-            return "";  // Return empty string if key not found
-        }
-        if (val.size() < BLOCK_SIZE) {
-            val.append(BLOCK_SIZE - val.size(), '\0');  // Ensure full 4KB block
-        }
-        return val;
-    }
-    
-    void del(const std::string &key) {
-        rocksdb::Status s = db->Delete(rocksdb::WriteOptions(), key);
-        if (!s.ok()) {
-            std::cerr << "Error in Delete: " << s.ToString() << std::endl;
-        }
-    }
-};
-
-class KeyValueCache {
-    std::unique_ptr<RocksDBWrapper> db;
-    std::unordered_map<std::string, std::pair<std::string, int>> kv_map;
-    std::unordered_map<std::string, std::shared_ptr<Slab>> slabs;
-    std::deque<std::string> free_slabs, active_slabs, reserve_slabs;
-    std::map<std::chrono::steady_clock::time_point, std::string> lru;
-
-    const int BLOCKS_PER_SLAB = 128;
-    const int NUM_CHANNELS = 2;
-    const double OP_RATIO = 0.2;
-    int total_slabs, low_wm, high_wm;
-
-    std::string block_key(const std::string &slab, int idx) {
-        return slab + ":" + std::to_string(idx);
-    }
-
-    void manage_op() {
-        static int dynamic_low_wm = total_slabs * 0.15;
-        static int dynamic_high_wm = total_slabs * 0.75;
-        const double growth_factor = 2.0;
-        const double shrink_factor = 0.9;
-
-        int max_reserve = total_slabs * 0.20; // Max 20% in reserve
-        int min_reserve = total_slabs * 0.10; // Maintain at least 10% of slabs in reserve
-
-        int prev_low_wm = dynamic_low_wm;
-        int prev_high_wm = dynamic_high_wm;
-
-        // Adjust watermarks dynamically
-        if (free_slabs.size() < dynamic_low_wm && dynamic_low_wm < total_slabs / 2) {
-            dynamic_low_wm = std::min(static_cast<int>(dynamic_low_wm * growth_factor), total_slabs / 2);
-            dynamic_high_wm = std::min(static_cast<int>(dynamic_high_wm * growth_factor), static_cast<int>(total_slabs * 0.9));
-        } 
-        else if (free_slabs.size() > dynamic_high_wm && dynamic_low_wm > total_slabs * 0.05) {
-            dynamic_low_wm = std::max(static_cast<int>(dynamic_low_wm * shrink_factor), static_cast<int>(total_slabs * 0.05));
-            dynamic_high_wm = std::max(static_cast<int>(dynamic_high_wm * shrink_factor), static_cast<int>(total_slabs * 0.6));
-        }
-
-        while (free_slabs.size() > dynamic_low_wm * 1.5 && reserve_slabs.size() < max_reserve) {
-            std::string slab = free_slabs.front();
-            free_slabs.pop_front();
-            reserve_slabs.push_back(slab);
-            //std::cout << "Moving slab to reserve: " << slab << "\n";
-        }
-
-        while (!reserve_slabs.empty() && free_slabs.size() < dynamic_low_wm) {
-            std::string slab = reserve_slabs.front();
-            reserve_slabs.pop_front();
-            free_slabs.push_back(slab);
-            //std::cout << "Reusing slab from reserve: " << slab << "\n";
-        }
-
-        if (free_slabs.size() < dynamic_low_wm / 2 && reserve_slabs.empty()) {
-            //std::cout << " CRITICAL: Free & Reserve slabs too low! Triggering GC...\n";
-            gc();
-        }
-    }
-
-    int gc_invoked_count = 0;  // Global or class member variable
-        
-    void gc() {
-        gc_invoked_count++;  
-        int slabs_freed = 0;
-
-        if (lru.empty()) {
-            std::cout << "GC: No slabs available for collection.\n";
-            return;
-        }
-
-        int gc_threshold = std::max((int)(active_slabs.size() * 0.50), 3000);
-        
-        //std::cout << " GC Invocation #" << gc_invoked_count 
-                //<< ": Attempting to free " << gc_threshold << " slabs...\n";
-
-        while (!lru.empty() && slabs_freed < gc_threshold) {
-            auto victim = lru.begin()->second;
-            lru.erase(lru.begin());
-            auto s = slabs[victim];
-
-            for (int i = 0; i < BLOCKS_PER_SLAB; i++) {
-                if (!s->free_blocks.count(i)) {
-                    std::string key_to_delete = block_key(victim, i);
-                    db->del(key_to_delete);
-                    s->free(i);
-                }
-            }
-
-            auto it = std::find(active_slabs.begin(), active_slabs.end(), victim);
-            if (it != active_slabs.end()) {
-                active_slabs.erase(it);
-            }
-
-            free_slabs.push_back(victim);
-            slabs_freed++;
-        }
-
-        //std::cout << " GC Completed. Freed " << slabs_freed << " slabs.\n";
-        //std::cout << "Total GC Invocations: " << gc_invoked_count << "\n";
-    }
-
-
-
-public:
-    KeyValueCache(const std::string &db_path) 
-        : db(std::make_unique<RocksDBWrapper>(db_path)) {
-        total_slabs =2000;
-        for (int i = 0; i < total_slabs; i++) {
-            auto sid = "slab_" + std::to_string(i);
-            slabs[sid] = std::make_shared<Slab>(sid, i % NUM_CHANNELS, BLOCKS_PER_SLAB);
-            free_slabs.push_back(sid);
-        }
-        manage_op();
-    }
-
-    void trigger_gc_op() {
-        manage_op();  // Call the private function
-    }
-
-    void put(const std::string &key, const std::string &val) {
-        if (kv_map.count(key)) {
-            auto &[slab, idx] = kv_map[key];
-            slabs[slab]->free(idx);
-            lru.erase(slabs[slab]->lru);
-        }
-
-        manage_op();
-
-        if (free_slabs.empty()) {
-            std::cout << "no free slabs available after manage_op(). exiting!\n";
-            return;
-        }
-
-        std::string slab_id = free_slabs.front();
-        free_slabs.pop_front();
-        active_slabs.push_back(slab_id);
-
-        int block_idx = slabs[slab_id]->alloc();
-        db->put(block_key(slab_id, block_idx), val);
-        kv_map[key] = {slab_id, block_idx};
-        lru[slabs[slab_id]->lru] = slab_id;
-    }
-
-
-    int hit_count = 0, miss_count = 0;
-    std::string get(const std::string &key) {
-        if (!kv_map.count(key)) {
-            miss_count++;
-            return "";
-        }
-        hit_count++;
-        auto &[slab, idx] = kv_map[key];
-        auto s = slabs[slab];
-        lru.erase(s->lru);
-        s->lru = std::chrono::steady_clock::now();
-        lru[s->lru] = slab;
-        return db->get(block_key(slab, idx));
-    }
-
-    void del(const std::string &key) {
-        if (kv_map.count(key)) {
-            auto &[slab, idx] = kv_map[key];
-
-            // Free the allocated block
-            slabs[slab]->free(idx);
-
-            // Remove from LRU tracking
-            lru.erase(slabs[slab]->lru);
-
-            // Delete from RocksDB
-            db->del(block_key(slab, idx));
-
-            // Remove from kv_map
-            kv_map.erase(key);
-        }
-    }
-
-    void print_hit_ratio() const {
-        int total = hit_count + miss_count;
-        if (total == 0) return;
-        std::cout << "Cache Hit Ratio: " << (hit_count * 100.0 / total) << "%\n";
-    }
-    void print_stats() const {
-        std::cout << "Free slabs: " << free_slabs.size()
-                  << " | Active slabs: " << active_slabs.size()
-                  << " | Reserved slabs: " << reserve_slabs.size() << "\n";
-    }
-};
+#include <thread>
+#include <filesystem>
+#include <deque>
+#include <future>
+#include <optional>
+#include "flash_kv_cache.h"
+
+// the configuration the benchmark has always measured: GC rounds free at least 3000 slabs and
+// RocksDB runs without automatic compactions, so GC's range deletes are never compacted away
+CacheOptions benchmark_options() {
+    CacheOptions opts;
+    opts.gc_floor = 3000;
+    opts.auto_compactions = false;
+    return opts;
+}
 
 void test_average_latency_and_throughput(KeyValueCache &cache, int num_operations, size_t object_size) {
     std::random_device rd;
@@ -278,6 +29,7 @@ void test_average_latency_and_throughput(KeyValueCache &cache, int num_operation
     double total_get_latency = 0;
 
     // Measure PUT throughput and average latency
+    size_t flash_bytes_before = cache.flash_bytes_written();
     auto start_put = std::chrono::high_resolution_clock::now();
     for (int i = 0; i < num_operations; i++) {
         std::string key = "key_" + std::to_string(i);  // ✅ 确保每次写入唯一 key
@@ -289,6 +41,7 @@ void test_average_latency_and_throughput(KeyValueCache &cache, int num_operation
     auto end_put = std::chrono::high_resolution_clock::now();
     double put_throughput = num_operations / std::chrono::duration<double>(end_put - start_put).count();
     double avg_put_latency = total_put_latency / num_operations;
+    double flash_bytes_per_put = (double)(cache.flash_bytes_written() - flash_bytes_before) / num_operations;
 
     // Measure GET throughput and average latency
     auto start_get = std::chrono::high_resolution_clock::now();
@@ -308,6 +61,44 @@ void test_average_latency_and_throughput(KeyValueCache &cache, int num_operation
     std::cout << "GET Throughput: " << get_throughput << " ops/sec\n";
     std::cout << "Average PUT Latency: " << avg_put_latency << " µs\n";
     std::cout << "Average GET Latency: " << avg_get_latency << " µs\n";
+    std::cout << "Flash Bytes per PUT: " << flash_bytes_per_put << " (write amplification: "
+              << flash_bytes_per_put / object_size << ")\n";
+}
+
+// repeated reads of a small key set that fits in the DRAM tier
+void test_hot_key_latency(KeyValueCache &cache, int num_operations) {
+    const int num_hot_keys = 1000;
+    std::string test_value(4096, 'x');
+    for (int i = 0; i < num_hot_keys; i++) {
+        cache.put("hot_" + std::to_string(i), test_value);
+    }
+
+    double total_get_latency = 0;
+    auto start_get = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < num_operations; i++) {
+        std::string key = "hot_" + std::to_string(i % num_hot_keys);
+        auto op_start = std::chrono::high_resolution_clock::now();
+        cache.get(key);
+        auto op_end = std::chrono::high_resolution_clock::now();
+        total_get_latency += std::chrono::duration_cast<std::chrono::nanoseconds>(op_end - op_start).count();
+    }
+    auto end_get = std::chrono::high_resolution_clock::now();
+    double get_throughput = num_operations / std::chrono::duration<double>(end_get - start_get).count();
+
+    std::cout << "Hot GET Throughput: " << get_throughput << " ops/sec\n";
+    std::cout << "Average Hot GET Latency: " << total_get_latency / num_operations / 1000 << " µs\n";
+
+    // same reads through one reused PinnableSlice, no allocation per GET
+    rocksdb::PinnableSlice val;
+    auto start_pinned = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < num_operations; i++) {
+        std::string key = "hot_" + std::to_string(i % num_hot_keys);
+        cache.get(key, &val);
+    }
+    auto end_pinned = std::chrono::high_resolution_clock::now();
+    double pinned_throughput = num_operations / std::chrono::duration<double>(end_pinned - start_pinned).count();
+
+    std::cout << "Pinned Hot GET Throughput: " << pinned_throughput << " ops/sec\n";
 }
 
 void test_cache_hit_ratio(KeyValueCache &cache, int num_operations) {
@@ -355,9 +146,360 @@ void test_gc_impact(KeyValueCache &cache, int num_operations) {
     //cache.print_stats();
 }
 
+// run fn on a cache opened on an empty db_path and remove the path again once it is closed. The
+// cache is handed over in an optional so fn can close and reopen it, as a restart test does
+template <typename Fn>
+void with_fresh_cache(const std::string &db_path, const CacheOptions &opts, Fn fn) {
+    std::filesystem::remove_all(db_path);
+    {
+        std::optional<KeyValueCache> cache(std::in_place, db_path, opts);
+        fn(cache);
+    }
+    std::filesystem::remove_all(db_path);
+}
+
+// cache-aside run over a skewed key space (80% of requests go to 20% of the keys) larger than
+// flash, so each victim policy decides what stays cached and how much GC rewrites
+void test_victim_policies(int num_operations) {
+    struct PolicyConfig {
+        const char *name;
+        VictimPolicy policy;
+        bool migrate;
+    };
+    std::vector<PolicyConfig> configs = {
+        {"LRU", VictimPolicy::LRU, false},
+        {"Greedy", VictimPolicy::GREEDY, false},
+        {"Cost-Benefit", VictimPolicy::COST_BENEFIT, false},
+        {"LRU + Migration", VictimPolicy::LRU, true},
+        {"Cost-Benefit + Migration", VictimPolicy::COST_BENEFIT, true},
+    };
+    int num_keys = std::max(5, num_operations / 2);
+    std::string test_value(4096, 'x');
+
+    for (auto &config : configs) {
+        std::mt19937 gen(42);  // same request sequence for every policy
+        std::uniform_real_distribution<double> coin(0, 1);
+        std::uniform_int_distribution<int> hot_key(0, num_keys / 5 - 1);
+        std::uniform_int_distribution<int> cold_key(num_keys / 5, num_keys - 1);
+        int hits = 0;
+        size_t bytes_put = 0, flash_bytes;
+        CacheOptions opts = benchmark_options();
+        opts.policy = config.policy;
+        opts.migrate = config.migrate;
+        with_fresh_cache("/tmp/kvcache_policy", opts, [&](std::optional<KeyValueCache> &cache) {
+            for (int i = 0; i < num_operations; i++) {
+                int k = coin(gen) < 0.8 ? hot_key(gen) : cold_key(gen);
+                std::string key = "key_" + std::to_string(k);
+                if (!cache->get(key).empty()) {
+                    hits++;
+                } else {
+                    cache->put(key, test_value);
+                    bytes_put += test_value.size();
+                }
+            }
+            flash_bytes = cache->flash_bytes_written();
+        });
+
+        std::cout << config.name << " | Hit Ratio: " << (hits * 100.0 / num_operations) << "%"
+                  << " | Write Amplification: " << (double)flash_bytes / bytes_put << "\n";
+    }
+}
+
+// skewed cache-aside reads (80% of requests to 20% of the keys) interleaved with a scan of
+// keys that are read once, run without and with TinyLFU admission in front of put
+void test_admission(int num_operations) {
+    int num_keys = std::max(5, num_operations / 4);
+    std::string test_value(4096, 'x');
+
+    for (bool admission : {false, true}) {
+        std::mt19937 gen(42);  // same request sequence for both runs
+        std::uniform_real_distribution<double> coin(0, 1);
+        std::uniform_int_distribution<int> hot_key(0, num_keys / 5 - 1);
+        std::uniform_int_distribution<int> cold_key(num_keys / 5, num_keys - 1);
+        CacheOptions opts = benchmark_options();
+        opts.admission = admission;
+        with_fresh_cache("/tmp/kvcache_admission", opts, [&](std::optional<KeyValueCache> &cache) {
+            for (int i = 0; i < num_operations; i++) {
+                std::string key;
+                if (i % 2) {
+                    key = "scan_" + std::to_string(i);  // one-hit wonder
+                } else {
+                    key = "key_" + std::to_string(coin(gen) < 0.8 ? hot_key(gen) : cold_key(gen));
+                }
+                if (cache->get(key).empty()) {
+                    cache->put(key, test_value);
+                }
+            }
+            std::cout << "\nAdmission " << (admission ? "on" : "off") << "\n";
+            cache->print_hit_ratio();
+            std::cout << "Flash Bytes Written: " << cache->flash_bytes_written() << "\n";
+        });
+    }
+}
+
+// aggregate throughput of a fresh cache driven by 1, 2, 4, ... threads on disjoint keys
+void test_thread_scaling(int num_operations, size_t object_size) {
+    int max_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<int> thread_counts;
+    for (int n = 1; n < max_threads; n *= 2) {
+        thread_counts.push_back(n);
+    }
+    thread_counts.push_back(max_threads);
+    std::string test_value(object_size, 'x');
+
+    for (int num_threads : thread_counts) {
+        double put_throughput, get_throughput;
+        CacheOptions opts = benchmark_options();
+        opts.num_shards = max_threads;
+        with_fresh_cache("/tmp/kvcache_threads", opts, [&](std::optional<KeyValueCache> &cache) {
+            int per_thread = num_operations / num_threads;
+
+            auto run = [&](auto op) {
+                std::vector<std::thread> workers;
+                auto start = std::chrono::high_resolution_clock::now();
+                for (int t = 0; t < num_threads; t++) {
+                    workers.emplace_back([&, t] {
+                        for (int i = 0; i < per_thread; i++) {
+                            op("key_" + std::to_string(t * per_thread + i));
+                        }
+                    });
+                }
+                for (auto &worker : workers) {
+                    worker.join();
+                }
+                auto end = std::chrono::high_resolution_clock::now();
+                return per_thread * num_threads / std::chrono::duration<double>(end - start).count();
+            };
+            put_throughput = run([&](const std::string &key) { cache->put(key, test_value); });
+            get_throughput = run([&](const std::string &key) { cache->get(key); });
+        });
+
+        std::cout << "Threads: " << num_threads
+                  << " | PUT Throughput: " << put_throughput << " ops/sec"
+                  << " | GET Throughput: " << get_throughput << " ops/sec\n";
+    }
+}
+
+// batched 4KB puts and multi-gets fanned out over 1, 2, 4 and 8 channels
+void test_channel_scaling(int num_operations) {
+    const int batch_size = 32;
+    std::string test_value(4096, 'x');
+
+    for (int num_channels : {1, 2, 4, 8}) {
+        double put_throughput, get_throughput;
+        CacheOptions opts = benchmark_options();
+        opts.num_channels = num_channels;
+        with_fresh_cache("/tmp/kvcache_channels", opts, [&](std::optional<KeyValueCache> &cache) {
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int i = 0; i < num_operations; i += batch_size) {
+                std::vector<std::pair<std::string, rocksdb::Slice>> batch;
+                for (int j = i; j < std::min(i + batch_size, num_operations); j++) {
+                    batch.emplace_back("key_" + std::to_string(j), test_value);
+                }
+                cache->batch_put(batch);
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            put_throughput = num_operations / std::chrono::duration<double>(end - start).count();
+
+            start = std::chrono::high_resolution_clock::now();
+            for (int i = 0; i < num_operations; i += batch_size) {
+                std::vector<std::string> keys;
+                for (int j = i; j < std::min(i + batch_size, num_operations); j++) {
+                    keys.push_back("key_" + std::to_string(j));
+                }
+                cache->multi_get(keys);
+            }
+            end = std::chrono::high_resolution_clock::now();
+            get_throughput = num_operations / std::chrono::duration<double>(end - start).count();
+        });
+
+        std::cout << "Channels: " << num_channels
+                  << " | BATCH PUT Throughput: " << put_throughput << " ops/sec"
+                  << " | MULTI GET Throughput: " << get_throughput << " ops/sec\n";
+    }
+}
+
+// write cost of each durability mode, PUTs with a delete every tenth operation. SYNC pays an
+// fsync per write, so it runs a thousandth of the operations and the modes compare by latency
+void test_durability(int num_operations) {
+    struct Mode {
+        const char *name;
+        Durability durability;
+        int num_operations;
+    };
+    std::vector<Mode> modes = {
+        {"No WAL", Durability::NONE, num_operations},
+        {"Group Commit", Durability::GROUP_COMMIT, num_operations},
+        {"Sync", Durability::SYNC, std::max(10, num_operations / 1000)},
+    };
+    std::string test_value(4096, 'x');
+
+    for (auto &mode : modes) {
+        CacheOptions opts = benchmark_options();
+        opts.durability = mode.durability;
+        with_fresh_cache("/tmp/kvcache_durability", opts, [&](std::optional<KeyValueCache> &cache) {
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int i = 0; i < mode.num_operations; i++) {
+                if (i % 10 == 9) {
+                    cache->del("key_" + std::to_string(i - 5));
+                } else {
+                    cache->put("key_" + std::to_string(i), test_value);
+                }
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            double seconds = std::chrono::duration<double>(end - start).count();
+            std::cout << mode.name << " | Operations: " << mode.num_operations
+                      << " | Write Throughput: " << mode.num_operations / seconds << " ops/sec"
+                      << " | Average Write Latency: " << seconds / mode.num_operations * 1e6 << " µs\n";
+        });
+    }
+}
+
+// warm restart: reopen a filled cache and time rebuilding its mapping from RocksDB
+void test_restart(int num_operations) {
+    std::string db_path = "/tmp/kvcache_restart";
+    std::string test_value(256, 'x');
+    CacheOptions opts = benchmark_options();
+    with_fresh_cache(db_path, opts, [&](std::optional<KeyValueCache> &cache) {
+        for (int i = 0; i < num_operations; i++) {
+            cache->put("key_" + std::to_string(i), test_value);
+        }
+        size_t keys_before = cache->mapped_keys();
+        cache.reset();
+
+        auto start = std::chrono::high_resolution_clock::now();
+        cache.emplace(db_path, opts);
+        auto end = std::chrono::high_resolution_clock::now();
+        std::cout << "Keys Before Restart: " << keys_before
+                  << " | Keys Recovered: " << cache->mapped_keys()
+                  << " | Index Bytes/Key: " << cache->index_bytes() / std::max<size_t>(1, cache->mapped_keys())
+                  << " | Restart Time: " << std::chrono::duration<double>(end - start).count() << " s\n";
+    });
+}
+
+// one caller thread reading 4KB values, one GET at a time and then with up to depth async GETs
+// in flight on the I/O pool
+void test_async_reads(int num_operations) {
+    const int depth = 64;
+    int num_keys = std::max(1, num_operations / 10);
+    std::string test_value(4096, 'x');
+
+    with_fresh_cache("/tmp/kvcache_async", benchmark_options(), [&](std::optional<KeyValueCache> &cache) {
+        for (int i = 0; i < num_keys; i++) {
+            cache->put("key_" + std::to_string(i), test_value);
+        }
+        std::mt19937 rng(7);
+        std::vector<std::string> keys;
+        for (int i = 0; i < num_keys; i++) {
+            keys.push_back("key_" + std::to_string(rng() % num_keys));
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (auto &key : keys) {
+            cache->get(key);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        double sync_throughput = num_keys / std::chrono::duration<double>(end - start).count();
+
+        start = std::chrono::high_resolution_clock::now();
+        std::deque<std::future<std::string>> in_flight;
+        for (auto &key : keys) {
+            if (in_flight.size() == depth) {
+                in_flight.front().get();
+                in_flight.pop_front();
+            }
+            in_flight.push_back(cache->async_get(key));
+        }
+        for (auto &f : in_flight) {
+            f.get();
+        }
+        end = std::chrono::high_resolution_clock::now();
+        double async_throughput = num_keys / std::chrono::duration<double>(end - start).count();
+
+        std::cout << "Sync GET Throughput: " << sync_throughput << " ops/sec"
+                  << " | Async GET Throughput (" << depth << " in flight): " << async_throughput << " ops/sec\n";
+    });
+}
+
+// first reads of 4KB values that left the DRAM tier long ago, without and with a prefetch hint
+// issued ahead of them
+void test_prefetch(int num_operations) {
+    const int batch = 128;
+    int num_keys = std::max(4096, num_operations / 10);
+    std::string test_value(4096, 'x');
+
+    CacheOptions opts = benchmark_options();
+    opts.dram_bytes = 4 << 20;  // the later writes push the first keys out of DRAM
+    with_fresh_cache("/tmp/kvcache_prefetch", opts, [&](std::optional<KeyValueCache> &cache) {
+        for (int i = 0; i < num_keys; i++) {
+            cache->put("key_" + std::to_string(i), test_value);
+        }
+
+        auto read_latency = [&](int first) {
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int i = first; i < first + batch; i++) {
+                cache->get("key_" + std::to_string(i));
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            return std::chrono::duration<double, std::micro>(end - start).count() / batch;
+        };
+        double cold = read_latency(0);
+
+        std::vector<std::string> hinted;
+        for (int i = batch; i < 2 * batch; i++) {
+            hinted.push_back("key_" + std::to_string(i));
+        }
+        cache->prefetch(hinted);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));  // the hint runs ahead of the reads
+        double warm = read_latency(batch);
+
+        std::cout << "Cold GET Latency: " << cold << " µs | Prefetched GET Latency: " << warm << " µs\n";
+        cache->print_hit_ratio();
+    });
+}
+
+// prompts that share a system prompt: each one probes for its longest cached prefix, reads
+// those pages and writes the pages of the rest, as an LLM engine reusing prefix KV pages would
+void test_prefix_reuse(int num_operations) {
+    const int shared_blocks = 16, prompt_blocks = 32;
+    int num_prompts = std::max(1, num_operations / 100);
+    std::string page(4096, 'p');
+    PageScope scope{"llama-7b", 0, 31};
+
+    with_fresh_cache("/tmp/kvcache_prefix", benchmark_options(), [&](std::optional<KeyValueCache> &cache) {
+        std::mt19937_64 rng(42);
+        double probe_time = 0, read_time = 0;
+        size_t cached_blocks = 0, pages_read = 0;
+        for (int p = 0; p < num_prompts; p++) {
+            std::vector<uint64_t> block_hashes;
+            for (int b = 0; b < prompt_blocks; b++) {
+                block_hashes.push_back(b < shared_blocks ? b : rng());
+            }
+
+            auto start = std::chrono::high_resolution_clock::now();
+            size_t cached = cache->longest_cached_prefix(scope, block_hashes);
+            auto mid = std::chrono::high_resolution_clock::now();
+            std::vector<std::string> pages = cache->get_pages(scope, block_hashes, cached);
+            auto end = std::chrono::high_resolution_clock::now();
+            probe_time += std::chrono::duration<double>(mid - start).count();
+            read_time += std::chrono::duration<double>(end - mid).count();
+            cached_blocks += cached;
+            pages_read += pages.size();
+
+            std::vector<rocksdb::Slice> fresh(prompt_blocks - cached, page);
+            cache->put_pages(scope, block_hashes, fresh, cached);
+        }
+        std::cout << "Prompts: " << num_prompts
+                  << " | Avg Cached Prefix: " << (double)cached_blocks / num_prompts << " of " << prompt_blocks << " blocks"
+                  << " | Prefix Probe Throughput: " << num_prompts / probe_time << " probes/sec"
+                  << " | Page GET Throughput: " << (read_time > 0 ? pages_read / read_time : 0) << " pages/sec\n";
+    });
+}
+
 int main() {
     std::cout << "=== Initializing RocksDB-based Key-Value Cache ===\n";
-    KeyValueCache cache("/tmp/kvcache4");
+    std::filesystem::remove_all("/tmp/kvcache4");  // start empty instead of recovering the last run
+    KeyValueCache cache("/tmp/kvcache4", benchmark_options());
 
     int num_operations = 1000000;
     std::vector<int> object_sizes = {256, 512, 1024, 2048, 4096};  // Different sizes for testing
@@ -368,6 +510,36 @@ int main() {
        test_average_latency_and_throughput(cache, num_operations, obj_size);
     }
 
+    std::cout << "\n=== Running Hot Key Read Tests ===\n";
+    test_hot_key_latency(cache, num_operations);
+
+    std::cout << "\n=== Running Victim Policy Tests ===\n";
+    test_victim_policies(num_operations);
+
+    std::cout << "\n=== Running Admission Tests ===\n";
+    test_admission(num_operations);
+
+    std::cout << "\n=== Running Durability Tests ===\n";
+    test_durability(num_operations);
+
+    std::cout << "\n=== Running Restart Tests ===\n";
+    test_restart(num_operations);
+
+    std::cout << "\n=== Running Thread Scaling Tests ===\n";
+    test_thread_scaling(num_operations, 4096);
+
+    std::cout << "\n=== Running Channel Scaling Tests ===\n";
+    test_channel_scaling(num_operations);
+
+    std::cout << "\n=== Running Async Read Tests ===\n";
+    test_async_reads(num_operations);
+
+    std::cout << "\n=== Running Prefetch Tests ===\n";
+    test_prefetch(num_operations);
+
+    std::cout << "\n=== Running Prefix Reuse Tests ===\n";
+    test_prefix_reuse(num_operations);
+
     //std::cout << "\n=== Running Cache Hit Ratio Test ===\n";
     //test_cache_hit_ratio(cache, num_operations);
 
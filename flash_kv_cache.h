@@ -0,0 +1,2494 @@
+// Flash key-value cache over RocksDB: slabs of 4KB blocks filled log-structured per channel,
+// an application-level userKey -> location mapping, application-driven GC and dynamic
+// over-provisioning. Header-only, shared by the prototype, benchmark and flash-kv-cache drivers.
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <deque>
+#include <list>
+#include <map>
+#include <memory>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <future>
+#include <limits>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include <rocksdb/db.h>
+#include <rocksdb/cache.h>
+#include <rocksdb/slice_transform.h>
+#include <rocksdb/filter_policy.h>
+#include <rocksdb/table.h>
+
+const int BLOCK_SIZE = 4096; 
+// slab size classes, values smaller than a block are packed several to a block
+const int SIZE_CLASSES[] = {256, 512, 1024, 2048, BLOCK_SIZE};
+const int NUM_CLASSES = sizeof(SIZE_CLASSES) / sizeof(SIZE_CLASSES[0]);
+const int BLOCKS_PER_SLAB = 128;
+const int MAX_SLOTS = BLOCKS_PER_SLAB * BLOCK_SIZE / SIZE_CLASSES[0];  // slots of a slab in the smallest class
+
+// what a write survives: NONE skips the WAL (a crash loses what the memtables held),
+// GROUP_COMMIT buffers the WAL and syncs it every OP_INTERVAL (a crash loses at most one
+// interval), SYNC syncs the WAL before every write returns
+enum class Durability { NONE, GROUP_COMMIT, SYNC };
+
+// how GC picks the slab to erase: least recently used, fewest live slots (greedy), or
+// the highest age * invalid / valid (cost-benefit)
+enum class VictimPolicy { LRU, GREEDY, COST_BENEFIT };
+
+// everything a deployment tunes. The defaults are meant to be deployed: RocksDB compacts away the
+// range tombstones GC leaves behind, and the GC floor is half of the slabs
+struct CacheOptions {
+    // geometry: slabs of BLOCKS_PER_SLAB blocks, split evenly over the shards. A shard keeps up to
+    // one open slab per size class and channel, so it needs well over NUM_CLASSES * num_channels slabs
+    int total_slabs = 2000;
+    int num_channels = 2;
+    int num_shards = 4;
+
+    // over-provisioning: initial watermarks and the reserve cap, as fractions of a shard's slabs
+    double low_wm_ratio = 0.15;
+    double high_wm_ratio = 0.75;
+    double max_reserve_ratio = 0.20;
+
+    // GC: victim policy, hot-value migration and the minimum number of slabs a round frees (a
+    // round ends early once a shard's free pool is back at the high watermark)
+    VictimPolicy policy = VictimPolicy::LRU;
+    bool migrate = false;
+    int gc_floor = 1000;
+
+    bool admission = false;            // TinyLFU admission of new keys once flash is half full
+    size_t dram_bytes = 64 << 20;      // DRAM hot tier over all shards
+    Durability durability = Durability::GROUP_COMMIT;
+
+    // RocksDB tuning
+    size_t block_cache_bytes = 256 << 20;
+    size_t memtable_bytes = 64 << 20;
+    bool direct_io = false;                  // bypass the page cache for reads, flushes and compactions
+    bool optimize_filters_for_hits = true;   // no bloom filters on the last level, most GETs hit
+    bool compression = false;
+    bool auto_compactions = true;    // reclaims the disk space of erased slabs
+    bool async_io = true;  // MultiGet and iterators overlap the reads of a batch where RocksDB supports it
+
+    // async API: worker threads and the number of requests that may wait for one
+    int io_threads = 8;
+    size_t io_queue_depth = 256;
+};
+
+// slab metadata is flat and fixed-size so millions of slabs fit in DRAM: written slots are
+// tracked in an occupancy bitmap and a shard keeps its slabs by index in one contiguous table
+struct Slab {
+    int id;
+    int next = -1;                // slab a value continues in when it runs past the last block, -1 if none
+    uint16_t channel;
+    uint16_t slot_size = BLOCK_SIZE;  // size class the slab is formatted for
+    uint16_t num_slots = BLOCKS_PER_SLAB;
+    uint16_t next_slot = 0;       // append cursor, slots are written sequentially
+    uint64_t live[MAX_SLOTS / 64] = {};  // bit per written slot whose value is still mapped
+    bool open = false;            // currently the write target of its channel
+    bool in_lru = false;          // sealed and linked into its shard's LRU list
+    uint8_t epoch = 0;            // erase count (wrapping), a mapping is valid only for the epoch it was written in
+    uint64_t sealed_at = 0;       // shard seal clock when the slab was filled, its age for cost-benefit
+    int lru_prev = -1, lru_next = -1;
+
+    Slab(int id, int chan) 
+        : id(id), channel(chan) {}
+
+    int slots_per_block() const { return BLOCK_SIZE / slot_size; }
+    bool full() const { return next_slot >= num_slots; }
+
+    int live_slots() const {
+        int n = 0;
+        for (uint64_t word : live) n += __builtin_popcountll(word);
+        return n;
+    }
+
+    // carve the slab into slots of one size class before it is opened for writes
+    void format(int size) {
+        slot_size = size;
+        num_slots = BLOCKS_PER_SLAB * slots_per_block();
+        reset();
+    }
+
+    // n consecutive slots, returns the first one
+    int alloc(int n = 1) {
+        if (next_slot + n > num_slots) return -1;
+        int idx = next_slot;
+        next_slot += n;
+        for (int i = idx; i < next_slot; i++) live[i / 64] |= 1ULL << (i % 64);
+        return idx;
+    }
+
+    // erase: every slot is writable again from the start of the slab
+    void reset() {
+        std::fill(std::begin(live), std::end(live), 0);
+        next_slot = 0;
+        open = false;
+        next = -1;
+        epoch++;
+    }
+
+    bool is_live(int idx) const {
+        return live[idx / 64] >> (idx % 64) & 1;
+    }
+
+    void free(int idx) {
+        live[idx / 64] &= ~(1ULL << (idx % 64));
+    }
+
+    void mark(int idx) {
+        live[idx / 64] |= 1ULL << (idx % 64);
+    }
+};
+
+// where a value lives: a block of a slab and the offset of its slot inside it,
+// values longer than a block cover `blocks` blocks starting there
+struct Location {
+    int slab = -1;  // -1: nowhere, allocation failed
+    int block;
+    int offset;
+    int blocks = 1;     // 1 for a value of up to a block
+    bool hot = false;   // read since written, migrated instead of erased by GC
+    uint8_t epoch = 0;  // Slab::epoch of the first slab when the value was written
+};
+
+// a Location packed into the 64 bits an index entry keeps, from the top: slab (28 bits), block (7),
+// offset in units of the smallest size class (4), blocks - 1 (16), hot (1) and epoch (8)
+const int MAX_SLABS = 1 << 28;
+const int MAX_RUN_BLOCKS = 1 << 16;  // values up to 256MB
+const uint64_t HOT_BIT = 1ULL << 8;
+
+inline uint64_t pack_location(const Location &loc) {
+    return (uint64_t)loc.slab << 36 | (uint64_t)loc.block << 29 | (uint64_t)(loc.offset / SIZE_CLASSES[0]) << 25 |
+           (uint64_t)(loc.blocks - 1) << 9 | (loc.hot ? HOT_BIT : 0) | loc.epoch;
+}
+
+inline Location unpack_location(uint64_t v) {
+    Location loc;
+    loc.slab = v >> 36;
+    loc.block = v >> 29 & 0x7f;
+    loc.offset = (v >> 25 & 0xf) * SIZE_CLASSES[0];
+    loc.blocks = (v >> 9 & 0xffff) + 1;
+    loc.hot = v & HOT_BIT;
+    loc.epoch = v & 0xff;
+    return loc;
+}
+
+// a block key is BLOCK_KEY_LEN bytes big-endian (slab << 32 | block << 16 | offset), so the keys
+// of a slab are one contiguous range sharing a SLAB_PREFIX_LEN prefix and blocks sort numerically.
+// The RocksDB key of a value's first block is its block key followed by the user key, the index
+// keeps only a fingerprint of the key and a Get for the full key verifies it on flash; the other
+// blocks of a run are stored under the bare block key. A bare block key fits std::string's inline
+// buffer, a first-block key is as long as the user key plus 8 bytes and may allocate
+const int SLAB_PREFIX_LEN = 4;
+const size_t BLOCK_KEY_LEN = 8;
+
+inline uint64_t block_id(int slab, int block, int offset = 0) {
+    return (uint64_t)slab << 32 | (uint64_t)block << 16 | (uint64_t)offset;
+}
+
+inline std::string block_key(int slab, int block, int offset = 0) {
+    uint64_t k = block_id(slab, block, offset);
+    std::string key(8, '\0');
+    for (int i = 7; i >= 0; i--, k >>= 8) {
+        key[i] = (char)(k & 0xff);
+    }
+    return key;
+}
+
+inline std::string block_key(const Location &loc) {
+    return block_key(loc.slab, loc.block, loc.offset);
+}
+
+// slab of a block key, the first SLAB_PREFIX_LEN bytes
+inline int slab_of(const rocksdb::Slice &key) {
+    uint32_t slab = 0;
+    for (int i = 0; i < SLAB_PREFIX_LEN; i++) {
+        slab = slab << 8 | (uint8_t)key[i];
+    }
+    return (int)slab;
+}
+
+inline uint64_t mix64(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// 64-bit fingerprint of a user key, 8 bytes at a time. It picks the shard and is persisted in
+// the mapping records, so unlike std::hash it must stay the same across builds
+inline uint64_t key_fingerprint(const rocksdb::Slice &key) {
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ key.size();
+    size_t i = 0;
+    for (; i + 8 <= key.size(); i += 8) {
+        uint64_t w;
+        memcpy(&w, key.data() + i, 8);
+        h = mix64(h ^ w);
+    }
+    uint64_t w = 0;
+    memcpy(&w, key.data() + i, key.size() - i);
+    return mix64(h ^ w);
+}
+
+// fingerprint stored big-endian at p, as in a mapping record key
+inline uint64_t fingerprint_at(const char *p) {
+    uint64_t fp = 0;
+    for (int i = 0; i < 8; i++) {
+        fp = fp << 8 | (uint8_t)p[i];
+    }
+    return fp;
+}
+
+inline void append_big_endian(std::string &s, uint64_t v, int bytes) {
+    for (int i = (bytes - 1) * 8; i >= 0; i -= 8) {
+        s.push_back((char)(v >> i & 0xff));
+    }
+}
+
+// KV pages of an LLM serving engine (e.g. vLLM prefix caching): a page belongs to a scope, the
+// model and layer range it holds, and is named by the rolling hash of the token blocks up to and
+// including its own, so equal hashes mean an equal prompt prefix
+struct PageScope {
+    std::string model;
+    int first_layer = 0;
+    int last_layer = 0;
+};
+
+// page keys are PAGE_KEY_TAG, both layers (4 bytes each), the model, then the chain hash (the
+// prefix hash of the first block) and the page's prefix hash, 8 bytes each big-endian. The tag
+// starts with a NUL byte, so page keys stay clear of ordinary string keys
+const std::string PAGE_KEY_TAG("\0kvp", 4);
+const size_t PAGE_KEY_SUFFIX_LEN = 16;
+
+inline bool is_page_key(const std::string &key) {
+    return key.size() >= PAGE_KEY_TAG.size() + 8 + PAGE_KEY_SUFFIX_LEN && key.compare(0, PAGE_KEY_TAG.size(), PAGE_KEY_TAG) == 0;
+}
+
+// keys of the pages of the first n token blocks, each block hash folded into the hash of its prefix
+inline std::vector<std::string> page_keys(const PageScope &scope, const std::vector<uint64_t> &block_hashes, size_t n) {
+    std::string base = PAGE_KEY_TAG;
+    append_big_endian(base, (uint32_t)scope.first_layer, 4);
+    append_big_endian(base, (uint32_t)scope.last_layer, 4);
+    base += scope.model;
+
+    std::vector<std::string> keys;
+    keys.reserve(n);
+    uint64_t prefix = 0x9e3779b97f4a7c15ULL;
+    uint64_t chain = 0;
+    for (size_t i = 0; i < n && i < block_hashes.size(); i++) {
+        prefix = mix64(prefix ^ mix64(block_hashes[i]));
+        if (i == 0) {
+            chain = prefix;
+        }
+        keys.push_back(base);
+        append_big_endian(keys.back(), chain, 8);
+        append_big_endian(keys.back(), prefix, 8);
+    }
+    return keys;
+}
+
+// hash that picks the shard of a key: the chain hash of a page key, so the pages of one prompt
+// prefix share a shard and its open slabs, and the fingerprint of any other key
+inline uint64_t route_hash(const std::string &key) {
+    if (is_page_key(key)) {
+        return fingerprint_at(key.data() + key.size() - PAGE_KEY_SUFFIX_LEN);
+    }
+    return key_fingerprint(key);
+}
+
+// mapping record of a key, stored under the shard prefix and the key fingerprint (big-endian):
+// slab, block, offset and length as fixed 32-bit fields in host byte order, followed by the
+// slabs a run longer than its first slab continues in
+const size_t LOCATION_RECORD_LEN = 16;
+// prefix of the stored layout, bumped when the record keys or values change meaning
+const std::string MAPPING_FORMAT = "fp:";
+
+inline void put_fixed32(char *p, int v) {
+    uint32_t u = (uint32_t)v;
+    memcpy(p, &u, sizeof(u));
+}
+
+inline int fixed32_at(const char *p) {
+    uint32_t u;
+    memcpy(&u, p, sizeof(u));
+    return (int)u;
+}
+
+// fixed part of the record of a value of length bytes into rec[0, LOCATION_RECORD_LEN)
+inline void encode_location(const Location &loc, size_t length, char *rec) {
+    put_fixed32(rec, loc.slab);
+    put_fixed32(rec + 4, loc.block);
+    put_fixed32(rec + 8, loc.offset);
+    put_fixed32(rec + 12, length);
+}
+
+// false for a record too short or with a partial chain entry
+inline bool decode_location(const rocksdb::Slice &rec, Location &loc, int &length, std::vector<int> &chain) {
+    if (rec.size() < LOCATION_RECORD_LEN || (rec.size() - LOCATION_RECORD_LEN) % 4 != 0) {
+        return false;
+    }
+    const char *p = rec.data();
+    loc.slab = fixed32_at(p);
+    loc.block = fixed32_at(p + 4);
+    loc.offset = fixed32_at(p + 8);
+    length = fixed32_at(p + 12);
+    chain.clear();
+    for (size_t off = LOCATION_RECORD_LEN; off < rec.size(); off += 4) {
+        chain.push_back(fixed32_at(p + off));
+    }
+    return true;
+}
+
+// WriteBatch space for a value: its bytes plus a record header (tag, key, length) per block
+inline size_t batch_bytes(size_t len) {
+    return len + (len / BLOCK_SIZE + 1) * 16;
+}
+
+// bounded DRAM copy of recently read and written values of up to a block, keyed by the
+// block id of their location so erasing a slab drops one contiguous id range. The user key is
+// kept with the value, a lookup by location only hits for the same key
+class DramTier {
+    struct Entry {
+        std::string key, val;
+        std::list<uint64_t>::iterator pos;
+        bool prefetched;                     // not read since a prefetch brought it in
+        std::list<uint64_t>::iterator upos;  // in unread while prefetched
+    };
+    size_t budget, used = 0;
+    std::map<uint64_t, Entry> entries;
+    std::list<uint64_t> lru;  // front is the most recently used
+    // prefetched entries not read yet, oldest first. They may take up to a quarter of the budget,
+    // beyond that the oldest is dropped as a wrong guess, so hints cannot flush the hot entries
+    std::list<uint64_t> unread;
+    size_t unread_bytes = 0;
+
+    void drop(std::map<uint64_t, Entry>::iterator it) {
+        size_t size = it->second.key.size() + it->second.val.size();
+        used -= size;
+        if (it->second.prefetched) {
+            unread_bytes -= size;
+            unread.erase(it->second.upos);
+        }
+        lru.erase(it->second.pos);
+        entries.erase(it);
+    }
+
+public:
+    explicit DramTier(size_t budget) : budget(budget) {}
+
+    // cached value of key at loc, null on a miss
+    const std::string *get(const Location &loc, const rocksdb::Slice &key) {
+        auto it = entries.find(block_id(loc.slab, loc.block, loc.offset));
+        if (it == entries.end() || it->second.key != key) {
+            return nullptr;
+        }
+        Entry &e = it->second;
+        if (e.prefetched) {
+            e.prefetched = false;
+            unread_bytes -= e.key.size() + e.val.size();
+            unread.erase(e.upos);
+            prefetch_hits++;
+        }
+        lru.splice(lru.begin(), lru, e.pos);
+        return &e.val;
+    }
+
+    bool contains(const Location &loc) const {
+        return entries.count(block_id(loc.slab, loc.block, loc.offset)) != 0;
+    }
+
+    void put(const Location &loc, const rocksdb::Slice &key, const rocksdb::Slice &val, bool prefetched = false) {
+        size_t size = key.size() + val.size();
+        if (budget == 0 || size > (prefetched ? budget / 4 : budget)) {
+            return;
+        }
+        erase(loc);
+        uint64_t id = block_id(loc.slab, loc.block, loc.offset);
+        lru.push_front(id);
+        Entry &e = entries[id] = {key.ToString(), val.ToString(), lru.begin(), prefetched, {}};
+        used += size;
+        if (prefetched) {
+            e.upos = unread.insert(unread.end(), id);
+            unread_bytes += size;
+            prefetched_count++;
+            while (unread_bytes > budget / 4) {
+                drop(entries.find(unread.front()));
+            }
+        }
+        while (used > budget) {
+            drop(entries.find(lru.back()));
+        }
+    }
+
+    int prefetched_count = 0, prefetch_hits = 0;
+
+    void erase(const Location &loc) {
+        auto it = entries.find(block_id(loc.slab, loc.block, loc.offset));
+        if (it != entries.end()) {
+            drop(it);
+        }
+    }
+
+    void erase_slab(int slab) {
+        auto it = entries.lower_bound(block_id(slab, 0));
+        while (it != entries.end() && it->first < block_id(slab + 1, 0)) {
+            drop(it++);
+        }
+    }
+};
+
+// flat open-addressing index from key fingerprint to packed location, 16 bytes per entry plus a
+// control byte. Keys are not kept in DRAM, a hit is verified against the key stored with the value
+// on flash. Swiss-table layout: entries come in groups of GROUP, each with a control byte holding 7
+// bits of the hash (or EMPTY / DELETED), and a lookup matches a whole group with one SSE2 compare.
+// Groups are probed in triangular order, which visits every group of a power-of-2 table
+class MappingIndex {
+public:
+    struct Entry {
+        uint64_t fp;
+        uint64_t loc;  // pack_location
+    };
+
+private:
+    static constexpr int GROUP = 16;
+    static constexpr int8_t EMPTY = -128;
+    static constexpr int8_t DELETED = -2;
+
+    std::vector<int8_t> ctrl;
+    std::vector<Entry> entries;
+    size_t num_groups = 0, count = 0, deleted = 0;
+
+    // fingerprints of one shard share their low bits (they picked the shard), so probe with a remix
+    static uint64_t probe_hash(uint64_t fp) {
+        return mix64(fp ^ 0x9e3779b97f4a7c15ULL);
+    }
+
+    // bitmask of the entries of group g whose control byte is c
+    uint32_t match(size_t g, int8_t c) const {
+#ifdef __SSE2__
+        __m128i group = _mm_loadu_si128((const __m128i *)&ctrl[g * GROUP]);
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(c)));
+#else
+        uint32_t m = 0;
+        for (int i = 0; i < GROUP; i++) {
+            m |= (uint32_t)(ctrl[g * GROUP + i] == c) << i;
+        }
+        return m;
+#endif
+    }
+
+    // first EMPTY or DELETED entry on the probe sequence of fp
+    size_t free_slot(uint64_t fp) const {
+        size_t g = probe_hash(fp) >> 7 & (num_groups - 1);
+        for (size_t step = 1;; step++) {
+            uint32_t m = match(g, EMPTY) | match(g, DELETED);
+            if (m) {
+                return g * GROUP + __builtin_ctz(m);
+            }
+            g = (g + step) & (num_groups - 1);
+        }
+    }
+
+    void rehash(size_t groups) {
+        std::vector<int8_t> old_ctrl(groups * GROUP, EMPTY);
+        std::vector<Entry> old_entries(groups * GROUP);
+        old_ctrl.swap(ctrl);
+        old_entries.swap(entries);
+        num_groups = groups;
+        deleted = 0;
+        for (size_t i = 0; i < old_ctrl.size(); i++) {
+            if (old_ctrl[i] >= 0) {
+                size_t j = free_slot(old_entries[i].fp);
+                ctrl[j] = old_ctrl[i];
+                entries[j] = old_entries[i];
+            }
+        }
+    }
+
+public:
+    size_t size() const {
+        return count;
+    }
+
+    // DRAM held by the table
+    size_t bytes() const {
+        return ctrl.size() + entries.size() * sizeof(Entry);
+    }
+
+    // entry of fp, null if none; valid until the next insert
+    Entry *find(uint64_t fp) {
+        if (num_groups == 0) {
+            return nullptr;
+        }
+        uint64_t h = probe_hash(fp);
+        int8_t h2 = h & 0x7f;
+        size_t g = h >> 7 & (num_groups - 1);
+        for (size_t step = 1;; step++) {
+            for (uint32_t m = match(g, h2); m; m &= m - 1) {
+                Entry &e = entries[g * GROUP + __builtin_ctz(m)];
+                if (e.fp == fp) {
+                    return &e;
+                }
+            }
+            if (match(g, EMPTY)) {
+                return nullptr;
+            }
+            g = (g + step) & (num_groups - 1);
+        }
+    }
+
+    void insert_or_assign(uint64_t fp, uint64_t loc) {
+        if (Entry *e = find(fp)) {
+            e->loc = loc;
+            return;
+        }
+        // at most 7/8 full counting tombstones; grow only if live entries fill half of that
+        if ((count + deleted + 1) * 8 > num_groups * GROUP * 7) {
+            rehash(num_groups == 0 ? 1 : (count + 1) * 16 > num_groups * GROUP * 7 ? num_groups * 2 : num_groups);
+        }
+        size_t i = free_slot(fp);
+        if (ctrl[i] == DELETED) {
+            deleted--;
+        }
+        ctrl[i] = probe_hash(fp) & 0x7f;
+        entries[i] = {fp, loc};
+        count++;
+    }
+
+    bool erase(uint64_t fp) {
+        Entry *e = find(fp);
+        if (!e) {
+            return false;
+        }
+        size_t i = e - entries.data();
+        // a lookup stops at a group with an empty entry, so only a full group needs a tombstone
+        if (match(i / GROUP, EMPTY)) {
+            ctrl[i] = EMPTY;
+        } else {
+            ctrl[i] = DELETED;
+            deleted++;
+        }
+        count--;
+        return true;
+    }
+};
+
+// one channel's I/O queue: a worker thread runs the jobs submitted to it in order, so requests
+// fanned out over several channels proceed in parallel like the dies of an open-channel SSD
+class ChannelQueue {
+    std::mutex mu;
+    std::condition_variable cv;
+    std::deque<std::function<void()>> jobs;
+    bool stopping = false;
+    std::thread worker;  // declared last, it starts once the queue is ready
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mu);
+        while (true) {
+            cv.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (jobs.empty()) {
+                return;
+            }
+            std::function<void()> job = std::move(jobs.front());
+            jobs.pop_front();
+            lock.unlock();
+            job();
+            lock.lock();
+        }
+    }
+
+public:
+    ChannelQueue() : worker(&ChannelQueue::run, this) {}
+
+    ~ChannelQueue() {
+        {
+            std::lock_guard<std::mutex> lock(mu);
+            stopping = true;
+        }
+        cv.notify_one();
+        worker.join();
+    }
+
+    void submit(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock(mu);
+            jobs.push_back(std::move(job));
+        }
+        cv.notify_one();
+    }
+};
+
+// worker threads behind the async API. At most depth jobs wait in the queue and a submit beyond
+// that blocks its caller until a worker takes one, so the outstanding I/O stays bounded
+class IoPool {
+    std::mutex mu;
+    std::condition_variable has_job, has_room;
+    std::deque<std::function<void()>> jobs;
+    size_t depth;
+    bool stopping = false;
+    std::vector<std::thread> workers;  // declared last, they start once the queue is ready
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mu);
+        while (true) {
+            has_job.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (jobs.empty()) {
+                return;  // stopping, and every queued job has run
+            }
+            std::function<void()> job = std::move(jobs.front());
+            jobs.pop_front();
+            has_room.notify_one();
+            lock.unlock();
+            job();
+            lock.lock();
+        }
+    }
+
+public:
+    IoPool(int threads, size_t depth) : depth(std::max<size_t>(1, depth)) {
+        for (int i = 0; i < std::max(1, threads); i++) {
+            workers.emplace_back(&IoPool::run, this);
+        }
+    }
+
+    ~IoPool() {
+        {
+            std::lock_guard<std::mutex> lock(mu);
+            stopping = true;
+        }
+        has_job.notify_all();
+        for (auto &worker : workers) {
+            worker.join();
+        }
+    }
+
+    void submit(std::function<void()> job) {
+        {
+            std::unique_lock<std::mutex> lock(mu);
+            has_room.wait(lock, [this] { return jobs.size() < depth; });
+            jobs.push_back(std::move(job));
+        }
+        has_job.notify_one();
+    }
+
+    // submit without waiting, false if the queue is full
+    bool try_submit(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock(mu);
+            if (jobs.size() >= depth) {
+                return false;
+            }
+            jobs.push_back(std::move(job));
+        }
+        has_job.notify_one();
+        return true;
+    }
+};
+
+// value blocks live in one column family per channel (channel 0 is the default one), picked by
+// slab id like Slab::channel, and the userKey -> location mapping in "mapping" so it survives a
+// restart; a value and its mapping record are always written in the same batch
+class RocksDBWrapper {
+    rocksdb::DB* db;
+    std::vector<rocksdb::ColumnFamilyHandle *> channel_cfs;  // [channel]
+    rocksdb::ColumnFamilyHandle *mapping_cf = nullptr;
+    std::vector<std::unique_ptr<ChannelQueue>> queues;       // [channel]
+    Durability durability;
+    rocksdb::WriteOptions write_opts;  // every write: values, mapping records, deletes and GC erases
+    rocksdb::ReadOptions read_opts;    // reads of value blocks
+
+    // jobs fanned out over channels and the caller waiting for the last of them
+    struct FanOut {
+        std::function<void(int)> job;
+        std::mutex mu;
+        std::condition_variable cv;
+        size_t left;
+    };
+
+    // column families of a database written with more channels are opened (RocksDB refuses to
+    // open a database without all of them) and dropped, their slabs map to other channels now
+    void open(const rocksdb::Options &opts, const std::string &path, int num_channels) {
+        std::vector<rocksdb::ColumnFamilyDescriptor> cfs = {{rocksdb::kDefaultColumnFamilyName, opts}};
+        for (int c = 1; c < num_channels; c++) {
+            cfs.emplace_back("channel" + std::to_string(c), opts);
+        }
+        cfs.emplace_back("mapping", rocksdb::ColumnFamilyOptions());
+        std::vector<std::string> existing;
+        rocksdb::DB::ListColumnFamilies(opts, path, &existing);  // fails for a new database
+        for (auto &name : existing) {
+            if (std::none_of(cfs.begin(), cfs.end(), [&](auto &cf) { return cf.name == name; })) {
+                cfs.emplace_back(name, opts);
+            }
+        }
+        std::vector<rocksdb::ColumnFamilyHandle *> handles;
+        rocksdb::Status s = rocksdb::DB::Open(opts, path, cfs, &handles, &db);
+        if (!s.ok()) {
+            std::cerr << "Error in Open: " << s.ToString() << std::endl;
+            exit(1);
+        }
+        channel_cfs.assign(handles.begin(), handles.begin() + num_channels);
+        mapping_cf = handles[num_channels];
+        for (size_t i = num_channels + 1; i < handles.size(); i++) {
+            db->DropColumnFamily(handles[i]);
+            db->DestroyColumnFamilyHandle(handles[i]);
+        }
+    }
+
+    rocksdb::ColumnFamilyHandle *cf_of(const rocksdb::Slice &block_key) {
+        return channel_cfs[channel_of(slab_of(block_key))];
+    }
+
+    // runs job(c) for every channel in chans and returns once all of them are done, the first
+    // on the calling thread and the others on their channel's worker
+    void fan_out(const std::vector<int> &chans, std::function<void(int)> job) {
+        if (chans.empty()) {
+            return;
+        }
+        FanOut fan;
+        fan.job = std::move(job);
+        fan.left = chans.size() - 1;
+        for (size_t i = 1; i < chans.size(); i++) {
+            queues[chans[i]]->submit([f = &fan, c = chans[i]] {
+                f->job(c);
+                std::lock_guard<std::mutex> lock(f->mu);
+                if (--f->left == 0) {
+                    f->cv.notify_one();
+                }
+            });
+        }
+        fan.job(chans[0]);
+        std::unique_lock<std::mutex> lock(fan.mu);
+        fan.cv.wait(lock, [&] { return fan.left == 0; });
+    }
+
+public:
+    std::atomic<size_t> bytes_written{0};  // shards write concurrently
+
+    RocksDBWrapper(const std::string& path, const CacheOptions &options) : durability(options.durability) {
+        rocksdb::Options opts;
+        opts.create_if_missing = true;
+        opts.create_missing_column_families = true;
+        write_opts.disableWAL = durability == Durability::NONE;
+        write_opts.sync = durability == Durability::SYNC;
+        read_opts.async_io = options.async_io;
+        opts.manual_wal_flush = durability == Durability::GROUP_COMMIT;  // flushed by sync_wal()
+        // bloom filters over block keys, with the slab as fixed prefix for per-slab scans
+        opts.prefix_extractor.reset(rocksdb::NewFixedPrefixTransform(SLAB_PREFIX_LEN));
+        rocksdb::BlockBasedTableOptions table_opts;
+        table_opts.filter_policy.reset(rocksdb::NewBloomFilterPolicy(10));
+        table_opts.block_cache = rocksdb::NewLRUCache(options.block_cache_bytes);  // shared by the channels
+        opts.table_factory.reset(rocksdb::NewBlockBasedTableFactory(table_opts));
+        // the memtable budget is split over the channels, and every channel can flush at once
+        opts.write_buffer_size = options.memtable_bytes / options.num_channels;
+        opts.max_background_jobs = std::max(opts.max_background_jobs, options.num_channels);
+        opts.use_direct_reads = options.direct_io;
+        opts.use_direct_io_for_flush_and_compaction = options.direct_io;
+        opts.optimize_filters_for_hits = options.optimize_filters_for_hits;
+        if (!options.compression) {
+            opts.compression = rocksdb::kNoCompression;
+        }
+        opts.disable_auto_compactions = !options.auto_compactions;
+        open(opts, path, options.num_channels);
+        for (int c = 0; c < options.num_channels; c++) {
+            queues.push_back(std::make_unique<ChannelQueue>());
+        }
+    }
+    ~RocksDBWrapper() {
+        queues.clear();
+        sync_wal();
+        for (auto *cf : channel_cfs) {
+            db->DestroyColumnFamilyHandle(cf);
+        }
+        db->DestroyColumnFamilyHandle(mapping_cf);
+        delete db;
+    }
+
+    int num_channels() const {
+        return channel_cfs.size();
+    }
+
+    int channel_of(int slab) const {
+        return slab % channel_cfs.size();
+    }
+
+    // group commit: write the buffered WAL and sync it, one fsync for every write since the last call
+    void sync_wal() {
+        if (durability != Durability::GROUP_COMMIT) {
+            return;
+        }
+        rocksdb::Status s = db->FlushWAL(true);
+        if (!s.ok()) {
+            std::cerr << "Error in Flush WAL: " << s.ToString() << std::endl;
+        }
+    }
+
+    void put(const std::string &key, const rocksdb::Slice &val) {
+        bytes_written += val.size();
+        rocksdb::Status s = db->Put(write_opts, cf_of(key), key, val);
+        if (!s.ok()) {
+            std::cerr << "Error in Put: " << s.ToString() << std::endl;
+        }
+    }
+
+    // add a value of up to a block to a batch under its block key and user key, the batch copies
+    // both straight from the caller's buffers
+    void stage(rocksdb::WriteBatch &batch, const std::string &block, const rocksdb::Slice &key, const rocksdb::Slice &val) {
+        rocksdb::Slice parts[2] = {block, key};
+        batch.Put(cf_of(block), rocksdb::SliceParts(parts, 2), rocksdb::SliceParts(&val, 1));
+        bytes_written += val.size();
+    }
+
+    // add a value to a batch under the keys of its blocks, one block-sized piece per key, the
+    // first one followed by the user key
+    void stage(rocksdb::WriteBatch &batch, const std::vector<std::string> &blocks, const rocksdb::Slice &key,
+               const rocksdb::Slice &val) {
+        stage(batch, blocks[0], key, rocksdb::Slice(val.data(), BLOCK_SIZE));
+        for (size_t i = 1; i < blocks.size(); i++) {
+            size_t off = i * BLOCK_SIZE;
+            batch.Put(cf_of(blocks[i]), blocks[i], rocksdb::Slice(val.data() + off, std::min<size_t>(BLOCK_SIZE, val.size() - off)));
+        }
+        bytes_written += val.size() - BLOCK_SIZE;
+    }
+
+    void write(rocksdb::WriteBatch &batch) {
+        rocksdb::Status s = db->Write(write_opts, &batch);
+        if (!s.ok()) {
+            std::cerr << "Error in Batch Put: " << s.ToString() << std::endl;
+        }
+    }
+
+    // batches[c] holds the values staged on channel c with their mapping records, the batches
+    // are written in parallel and each one is atomic on its own
+    void write(std::vector<rocksdb::WriteBatch> &batches) {
+        static thread_local std::vector<int> chans;
+        chans.clear();
+        for (size_t c = 0; c < batches.size(); c++) {
+            if (batches[c].Count() > 0) {
+                chans.push_back(c);
+            }
+        }
+        fan_out(chans, [this, &batches](int c) { write(batches[c]); });
+    }
+    
+    std::string get(const std::string &key) {
+        std::string val;
+        rocksdb::Status s = db->Get(read_opts, cf_of(key), key, &val);
+        if (!s.ok()) {
+            return "";  // return empty string if key not found
+        }
+        return val;
+    }
+
+    // value pinned in the block cache when RocksDB can, copied into val's own buffer otherwise
+    bool get(const std::string &key, rocksdb::PinnableSlice *val) {
+        return db->Get(read_opts, cf_of(key), key, val).ok();
+    }
+
+    // many keys with one MultiGet per channel, the channels in parallel; found[i] is false for a
+    // key that is not stored. Sorted input stays sorted per channel, so RocksDB walks the keys in
+    // order without sorting them again
+    std::vector<std::string> multi_get(const std::vector<std::string> &keys, std::vector<bool> &found, bool sorted = false) {
+        std::vector<std::vector<size_t>> by_channel(channel_cfs.size());
+        for (size_t i = 0; i < keys.size(); i++) {
+            by_channel[channel_of(slab_of(keys[i]))].push_back(i);
+        }
+        std::vector<int> chans;
+        for (size_t c = 0; c < by_channel.size(); c++) {
+            if (!by_channel[c].empty()) {
+                chans.push_back(c);
+            }
+        }
+        std::vector<std::string> vals(keys.size());
+        std::vector<char> ok(keys.size(), 0);  // not vector<bool>, channels set their entries concurrently
+        fan_out(chans, [&](int c) {
+            const std::vector<size_t> &idx = by_channel[c];
+            std::vector<rocksdb::Slice> slices;
+            slices.reserve(idx.size());
+            for (size_t i : idx) {
+                slices.push_back(keys[i]);
+            }
+            std::vector<rocksdb::PinnableSlice> blocks(idx.size());
+            std::vector<rocksdb::Status> s(idx.size());
+            db->MultiGet(read_opts, channel_cfs[c], idx.size(),
+                         slices.data(), blocks.data(), s.data(), sorted);
+            for (size_t j = 0; j < idx.size(); j++) {
+                if (s[j].ok()) {
+                    vals[idx[j]].assign(blocks[j].data(), blocks[j].size());
+                    ok[idx[j]] = 1;
+                }
+            }
+        });
+        found.assign(ok.begin(), ok.end());
+        return vals;
+    }
+
+    // user key and value of the first block stored at block, for GC, which knows values by location only
+    bool get_at(const std::string &block, std::string *key, std::string *val) {
+        std::unique_ptr<rocksdb::Iterator> it(db->NewIterator(read_opts, cf_of(block)));
+        it->Seek(block);
+        if (!it->Valid() || !it->key().starts_with(block)) {
+            return false;
+        }
+        key->assign(it->key().data() + BLOCK_KEY_LEN, it->key().size() - BLOCK_KEY_LEN);
+        val->assign(it->value().data(), it->value().size());
+        return true;
+    }
+
+    // blocks of a run fetched with one MultiGet and appended to val, false if any of them is gone
+    bool get_run(const std::vector<std::string> &keys, std::string *val) {
+        val->clear();
+        int chan = channel_of(slab_of(keys[0]));
+        if (std::any_of(keys.begin(), keys.end(), [&](auto &key) { return channel_of(slab_of(key)) != chan; })) {
+            // chained into a slab of another channel
+            std::vector<bool> found;
+            std::vector<std::string> blocks = multi_get(keys, found);
+            for (size_t i = 0; i < keys.size(); i++) {
+                if (!found[i]) {
+                    return false;
+                }
+                val->append(blocks[i]);
+            }
+            return true;
+        }
+        std::vector<rocksdb::Slice> slices(keys.begin(), keys.end());
+        std::vector<rocksdb::PinnableSlice> blocks(keys.size());
+        std::vector<rocksdb::Status> s(keys.size());
+        db->MultiGet(read_opts, channel_cfs[chan], keys.size(),
+                     slices.data(), blocks.data(), s.data());
+        val->reserve(keys.size() * BLOCK_SIZE);
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (!s[i].ok()) {
+                return false;
+            }
+            val->append(blocks[i].data(), blocks[i].size());
+        }
+        return true;
+    }
+    
+    void del(const std::string &key) {
+        rocksdb::Status s = db->Delete(write_opts, cf_of(key), key);
+        if (!s.ok()) {
+            std::cerr << "Error in Delete: " << s.ToString() << std::endl;
+        }
+    }
+
+    // erase every key in [begin, end) of one slab with a single range tombstone
+    void delete_range(const std::string &begin, const std::string &end) {
+        rocksdb::Status s = db->DeleteRange(write_opts, cf_of(begin), begin, end);
+        if (!s.ok()) {
+            std::cerr << "Error in Delete Range: " << s.ToString() << std::endl;
+        }
+    }
+
+    // mapping record of the key with fingerprint fp in the shard with prefix
+    static std::string mapping_key(const std::string &prefix, uint64_t fp) {
+        std::string key = prefix;
+        append_big_endian(key, fp, 8);
+        return key;
+    }
+
+    void stage_mapping(rocksdb::WriteBatch &batch, const std::string &prefix, uint64_t fp, const rocksdb::Slice &rec) {
+        batch.Put(mapping_cf, mapping_key(prefix, fp), rec);
+    }
+
+    void stage_unmap(rocksdb::WriteBatch &batch, const std::string &prefix, uint64_t fp) {
+        batch.Delete(mapping_cf, mapping_key(prefix, fp));
+    }
+
+    void stage_del(rocksdb::WriteBatch &batch, const std::string &key) {
+        batch.Delete(cf_of(key), key);
+    }
+
+    // iterator over the mapping records, each shard scans its own prefix
+    std::unique_ptr<rocksdb::Iterator> scan_mapping() {
+        return std::unique_ptr<rocksdb::Iterator>(db->NewIterator(rocksdb::ReadOptions(), mapping_cf));
+    }
+
+    // the shard layout the mapping was written with, stored under the empty key
+    std::string layout() {
+        std::string val;
+        db->Get(rocksdb::ReadOptions(), mapping_cf, "", &val);
+        return val;
+    }
+
+    void set_layout(const std::string &layout) {
+        rocksdb::Status s = db->Put(write_opts, mapping_cf, "", layout);
+        if (!s.ok()) {
+            std::cerr << "Error in Put: " << s.ToString() << std::endl;
+        }
+    }
+
+    // drop every mapping record and value block, for a layout the shards cannot map back. The
+    // range covers every slab ID a packed location can hold, not just the new slab count, so keys
+    // of slabs a larger earlier layout had do not survive into the next recovery
+    void clear() {
+        for (auto *cf : channel_cfs) {
+            rocksdb::Status s = db->DeleteRange(write_opts, cf, block_key(0, 0), block_key(MAX_SLABS, 0));
+            if (!s.ok()) {
+                std::cerr << "Error in Delete Range: " << s.ToString() << std::endl;
+            }
+        }
+        rocksdb::Status s = db->DeleteRange(write_opts, mapping_cf, std::string(1, '\0'), block_key(MAX_SLABS, 0));
+        if (!s.ok()) {
+            std::cerr << "Error in Delete Range: " << s.ToString() << std::endl;
+        }
+    }
+
+};
+
+// TinyLFU admission filter: a doorkeeper bloom filter absorbs the first request of a key and a
+// count-min sketch counts the ones after it. Both are aged every sample_size requests (counters
+// halved, doorkeeper cleared) so popularity from long ago fades out
+class TinyLFU {
+    static const int DEPTH = 4;
+    static const int DOOR_PROBES = 2;
+    static const int MAX_COUNT = 15;
+    std::vector<uint8_t> counters;     // DEPTH rows of width counters
+    std::vector<uint64_t> doorkeeper;  // sized for the distinct keys of a sample window
+    size_t width_mask, door_mask;
+    size_t samples = 0, sample_size;
+
+    struct Probes {
+        size_t counter[DEPTH];  // row r at r * width
+        size_t door[DOOR_PROBES];
+    };
+
+    static uint64_t mix(uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    // positions by double hashing of one key hash
+    Probes probes(const std::string &key) const {
+        uint64_t h1 = mix(std::hash<std::string>{}(key));
+        uint64_t h2 = mix(h1) | 1;
+        Probes p;
+        for (int r = 0; r < DEPTH; r++) {
+            p.counter[r] = r * (width_mask + 1) + ((h1 + r * h2) & width_mask);
+        }
+        for (int i = 0; i < DOOR_PROBES; i++) {
+            p.door[i] = ((h1 >> 32) + (DEPTH + i) * h2) & door_mask;
+        }
+        return p;
+    }
+
+    bool in_doorkeeper(const Probes &p) const {
+        for (size_t bit : p.door) {
+            if (!((doorkeeper[bit / 64] >> (bit % 64)) & 1)) return false;
+        }
+        return true;
+    }
+
+    void age() {
+        for (auto &c : counters) c >>= 1;
+        std::fill(doorkeeper.begin(), doorkeeper.end(), 0);
+        samples = 0;
+    }
+
+public:
+    explicit TinyLFU(size_t expected_keys) {
+        size_t width = 64;
+        while (width < expected_keys) width <<= 1;
+        width_mask = width - 1;
+        counters.assign(DEPTH * width, 0);
+        sample_size = 10 * width;
+        door_mask = 16 * width - 1;
+        doorkeeper.assign(16 * width / 64, 0);
+    }
+
+    void record(const std::string &key) {
+        Probes p = probes(key);
+        if (!in_doorkeeper(p)) {
+            for (size_t bit : p.door) doorkeeper[bit / 64] |= 1ULL << (bit % 64);
+        } else {
+            // conservative update: only the smallest counters grow
+            uint8_t low = MAX_COUNT;
+            for (size_t c : p.counter) low = std::min(low, counters[c]);
+            for (size_t c : p.counter) {
+                if (counters[c] == low && low < MAX_COUNT) counters[c]++;
+            }
+        }
+        if (++samples >= sample_size) {
+            age();
+        }
+    }
+
+    int estimate(const std::string &key) const {
+        Probes p = probes(key);
+        int count = MAX_COUNT;
+        for (size_t c : p.counter) count = std::min<int>(count, counters[c]);
+        return count + in_doorkeeper(p);
+    }
+
+    // a key is worth a flash write once it has been requested twice within the window
+    bool admit(const std::string &key) const {
+        return estimate(key) >= 2;
+    }
+};
+
+// one partition of the cache: its own mapping, slab pool and LRU over a slice of the slabs.
+// Not thread-safe by itself, KeyValueCache holds mu around every call.
+class CacheShard {
+    friend class KeyValueCache;
+
+    RocksDBWrapper *db;  // shared by all shards
+    std::mutex mu;
+    MappingIndex index;       // key fingerprint -> location
+    std::vector<Slab> slabs;  // slabs[id - first_slab]
+    // reverse index, owners[id - first_slab] holds the fingerprint of every value written into the
+    // slab this epoch. A fingerprint counts only while the index still maps it into the slab: an
+    // overwritten or deleted value has moved on or is gone
+    std::vector<std::vector<uint64_t>> owners;
+    std::deque<int> free_slabs, reserve_slabs;
+    int lru_head = -1, lru_tail = -1;  // intrusive LRU of sealed slabs, head is the least recently used
+    int sealed_count = 0;              // slabs in the LRU, the GC candidates
+    std::vector<std::vector<int>> open_slabs;  // [size class][channel] append target, -1 if none
+    int next_channel = 0;
+
+    const int NUM_CHANNELS;
+    const double max_reserve_ratio;
+    int total_slabs;
+    int dynamic_low_wm, dynamic_high_wm;
+    int gc_floor;  // minimum number of slabs a GC round frees unless the high watermark is reached first
+    int first_slab;
+    std::string map_prefix;  // mapping records of this shard's keys: first_slab big-endian + key fingerprint
+    VictimPolicy policy;
+    bool migrate;             // move hot values out of a victim before erasing it
+    bool migrating = false;
+    uint64_t seal_clock = 0;  // number of slabs sealed so far
+    // GREEDY / COST_BENEFIT: slabs queued for erase by the last scoring pass with the seal clock
+    // they were sealed at, the next one last
+    std::vector<std::pair<int, uint64_t>> victims;
+    std::vector<std::pair<double, int>> victim_scores;  // queue_victims scratch
+    std::unique_ptr<TinyLFU> admission;  // null: every write goes to flash
+    DramTier dram;
+    std::vector<Location> batch_locs;  // stage_batch scratch, kept to reuse its capacity
+    std::vector<uint64_t> batch_fps;
+    std::vector<size_t> by_class[NUM_CLASSES];
+
+    Slab &slab_at(int id) {
+        return slabs[id - first_slab];
+    }
+
+    // smallest size class that holds len bytes
+    int size_class(size_t len) {
+        for (int c = 0; c < NUM_CLASSES; c++) {
+            if (len <= (size_t)SIZE_CLASSES[c]) return c;
+        }
+        return NUM_CLASSES - 1;
+    }
+
+    int slots_needed(size_t len, int cls) {
+        return std::max<int>(1, (len + SIZE_CLASSES[cls] - 1) / SIZE_CLASSES[cls]);
+    }
+
+    Location slot_location(int slab, int slot, int blocks = 1) {
+        Slab *s = &slab_at(slab);
+        return {slab, slot / s->slots_per_block(), slot % s->slots_per_block() * s->slot_size, blocks, false, s->epoch};
+    }
+
+    // false once the value's first slab was erased after it was written
+    bool current(const Location &loc) {
+        return slab_at(loc.slab).epoch == loc.epoch;
+    }
+
+    int slot_of(const Location &loc) {
+        Slab *s = &slab_at(loc.slab);
+        return loc.block * s->slots_per_block() + loc.offset / s->slot_size;
+    }
+
+    // (slab, block) pairs of a value, following the slab chain for values longer than a slab,
+    // empty once GC has reclaimed a slab of the chain
+    std::vector<std::pair<int, int>> run_blocks(const Location &loc) {
+        std::vector<std::pair<int, int>> run;
+        int slab = loc.slab;
+        int block = loc.block;
+        while ((int)run.size() < loc.blocks) {
+            if (block == BLOCKS_PER_SLAB) {
+                slab = slab_at(slab).next;
+                block = 0;
+                if (slab < 0) {
+                    return {};  // chain cut by GC, the value is gone
+                }
+            }
+            run.emplace_back(slab, block++);
+        }
+        return run;
+    }
+
+    // block keys of a value, for writing it
+    std::vector<std::string> block_keys(const Location &loc) {
+        if (loc.blocks == 1) {
+            return {block_key(loc)};
+        }
+        std::vector<std::string> keys;
+        for (auto &[slab, block] : run_blocks(loc)) {
+            keys.push_back(block_key(slab, block));
+        }
+        return keys;
+    }
+
+    // RocksDB keys a value is stored under, the first block's followed by the user key
+    std::vector<std::string> value_keys(const Location &loc, const std::string &key) {
+        std::vector<std::string> keys = block_keys(loc);
+        if (!keys.empty()) {
+            keys[0] += key;
+        }
+        return keys;
+    }
+
+    // key of a value of up to a block, built in a buffer that keeps its capacity across reads
+    const std::string &value_key(const Location &loc, const std::string &key) {
+        static thread_local std::string buf;
+        buf = block_key(loc);
+        buf += key;
+        return buf;
+    }
+
+    // persist fp -> loc in the batch that writes the value, a run spanning several slabs
+    // also records the slabs it continues in so recovery can relink the chain
+    void stage_mapping(rocksdb::WriteBatch &batch, uint64_t fp, const Location &loc, size_t length) {
+        char rec[LOCATION_RECORD_LEN];
+        encode_location(loc, length, rec);
+        if (loc.block + loc.blocks <= BLOCKS_PER_SLAB) {
+            db->stage_mapping(batch, map_prefix, fp, rocksdb::Slice(rec, sizeof(rec)));
+            return;
+        }
+        std::string chained(rec, sizeof(rec));
+        for (auto &[slab, block] : run_blocks(loc)) {
+            if (block == 0 && slab != loc.slab) {
+                char id[4];
+                put_fixed32(id, slab);
+                chained.append(id, sizeof(id));
+            }
+        }
+        db->stage_mapping(batch, map_prefix, fp, chained);
+    }
+
+    // point fp at loc and add it to the reverse index of every slab the value covers
+    void map_entry(uint64_t fp, const Location &loc) {
+        index.insert_or_assign(fp, pack_location(loc));
+        if (loc.blocks == 1) {
+            owners[loc.slab - first_slab].push_back(fp);
+            return;
+        }
+        int prev = -1;
+        for (auto &[slab, block] : run_blocks(loc)) {
+            if (slab != prev) {
+                owners[slab - first_slab].push_back(fp);
+                prev = slab;
+            }
+        }
+    }
+
+    // current location of fp if it covers slab, a value that starts there or a run continuing into it
+    bool maps_into(uint64_t fp, int slab, Location &loc) {
+        MappingIndex::Entry *e = index.find(fp);
+        if (!e) {
+            return false;
+        }
+        loc = unpack_location(e->loc);
+        if (loc.slab == slab || loc.blocks == 1) {
+            return loc.slab == slab;
+        }
+        auto run = run_blocks(loc);
+        return std::any_of(run.begin(), run.end(), [&](auto &b) { return b.first == slab; });
+    }
+
+    // drop every mapping into a slab that is about to be erased, values that start in it and runs
+    // that continue into it, in O(values written to the slab) instead of a scan of the index
+    void unmap_slab(int slab, rocksdb::WriteBatch &batch) {
+        Location loc;
+        for (uint64_t fp : owners[slab - first_slab]) {
+            if (!maps_into(fp, slab, loc)) {
+                continue;  // moved, deleted, or already dropped as a duplicate
+            }
+            release(loc);
+            db->stage_unmap(batch, map_prefix, fp);
+            index.erase(fp);
+        }
+        owners[slab - first_slab].clear();
+    }
+
+    // give back the slots of an overwritten or deleted value
+    void release(const Location &loc) {
+        if (loc.blocks == 1) {
+            dram.erase(loc);
+            slab_at(loc.slab).free(slot_of(loc));
+            return;
+        }
+        for (auto &[slab, block] : run_blocks(loc)) {
+            slab_at(slab).free(block);
+        }
+    }
+
+    void lru_unlink(int slab) {
+        Slab &s = slab_at(slab);
+        if (!s.in_lru) {
+            return;
+        }
+        if (s.lru_prev < 0) {
+            lru_head = s.lru_next;
+        } else {
+            slab_at(s.lru_prev).lru_next = s.lru_next;
+        }
+        if (s.lru_next < 0) {
+            lru_tail = s.lru_prev;
+        } else {
+            slab_at(s.lru_next).lru_prev = s.lru_prev;
+        }
+        s.lru_prev = s.lru_next = -1;
+        s.in_lru = false;
+    }
+
+    // link at the most recently used end
+    void lru_push(int slab) {
+        Slab &s = slab_at(slab);
+        s.lru_prev = lru_tail;
+        s.lru_next = -1;
+        if (lru_tail < 0) {
+            lru_head = slab;
+        } else {
+            slab_at(lru_tail).lru_next = slab;
+        }
+        lru_tail = slab;
+        s.in_lru = true;
+    }
+
+    // open slabs are not GC candidates yet, they enter the LRU when sealed
+    void touch(int slab) {
+        if (slab_at(slab).in_lru) {
+            lru_unlink(slab);
+            lru_push(slab);
+        }
+    }
+
+    // open slab of a size class on a channel, taking a new one from free_slabs if needed
+    int open_slab(int cls, int chan) {
+        int &slab = open_slabs[cls][chan];
+        if (slab >= 0 || free_slabs.empty()) {
+            return slab;
+        }
+        auto it = std::find_if(free_slabs.begin(), free_slabs.end(),
+                               [&](int id) { return slab_at(id).channel == chan; });
+        if (it == free_slabs.end()) {
+            it = free_slabs.begin();
+        }
+        slab = *it;
+        free_slabs.erase(it);
+        slab_at(slab).format(SIZE_CLASSES[cls]);
+        slab_at(slab).open = true;
+        return slab;
+    }
+
+    // full slab leaves its channel and becomes a GC candidate
+    void seal_slab(int cls, int chan) {
+        int slab = open_slabs[cls][chan];
+        Slab *s = &slab_at(slab);
+        s->open = false;
+        s->sealed_at = ++seal_clock;
+        sealed_count++;
+        lru_push(slab);
+        open_slabs[cls][chan] = -1;
+    }
+
+    // next channel in round-robin order that has an open slab of the size class, -1 if none
+    int pick_channel(int cls) {
+        for (int i = 0; i < NUM_CHANNELS; i++) {
+            int chan = (next_channel + i) % NUM_CHANNELS;
+            if (open_slab(cls, chan) >= 0) {
+                next_channel = (chan + 1) % NUM_CHANNELS;
+                return chan;
+            }
+        }
+        if (make_room()) {
+            return pick_channel(cls);
+        }
+        return -1;
+    }
+
+    // n consecutive slots on a channel, a run that does not fit behind the data already in
+    // the open slab starts a fresh one and continues into chained slabs past its last block
+    Location alloc_run(int cls, int chan, int n) {
+        int slab_id = open_slab(cls, chan);
+        Slab *s = &slab_at(slab_id);
+        if (s->next_slot > 0 && s->next_slot + n > s->num_slots) {
+            seal_slab(cls, chan);
+            slab_id = open_slab(cls, chan);
+            if (slab_id < 0 && make_room()) {
+                slab_id = open_slab(cls, chan);
+            }
+            if (slab_id < 0) {
+                return {};
+            }
+            s = &slab_at(slab_id);
+        }
+        int chained = (n - 1) / s->num_slots;
+        while (chained > (int)free_slabs.size()) {
+            if (!make_room()) {
+                return {};
+            }
+        }
+
+        int take = std::min(n, s->num_slots - s->next_slot);
+        Location loc = slot_location(slab_id, s->alloc(take), n);
+        for (n -= take; n > 0; n -= take) {
+            seal_slab(cls, chan);
+            int next = open_slab(cls, chan);
+            s->next = next;
+            s = &slab_at(next);
+            take = std::min<int>(n, s->num_slots);
+            s->alloc(take);
+        }
+        if (s->full()) {
+            seal_slab(cls, chan);
+        }
+        return loc;
+    }
+
+    // n single slots of a size class in one call, filling open slabs channel after channel
+    void alloc_slots(int cls, const std::vector<size_t> &idx, std::vector<Location> &locs) {
+        size_t n = 0;
+        while (n < idx.size()) {
+            int chan = pick_channel(cls);
+            if (chan < 0) {
+                break;
+            }
+            int slab_id = open_slabs[cls][chan];
+            Slab *s = &slab_at(slab_id);
+            int take = std::min<int>(idx.size() - n, s->num_slots - s->next_slot);
+            int first = s->alloc(take);
+            for (int i = 0; i < take; i++) {
+                locs[idx[n++]] = slot_location(slab_id, first + i);
+            }
+            if (s->full()) {
+                seal_slab(cls, chan);
+            }
+        }
+    }
+
+    void manage_op() {
+        const double growth_factor = 2.0;
+        const double shrink_factor = 0.9;
+
+        int max_reserve = total_slabs * max_reserve_ratio;
+
+        // adjust watermarks dynamically
+        if (free_slabs.size() < dynamic_low_wm && dynamic_low_wm < total_slabs / 2) {
+            dynamic_low_wm = std::min(static_cast<int>(dynamic_low_wm * growth_factor), total_slabs / 2);
+            dynamic_high_wm = std::min(static_cast<int>(dynamic_high_wm * growth_factor), static_cast<int>(total_slabs * 0.9));
+        } 
+        else if (free_slabs.size() > dynamic_high_wm && dynamic_low_wm > total_slabs * 0.05) {
+            dynamic_low_wm = std::max(static_cast<int>(dynamic_low_wm * shrink_factor), static_cast<int>(total_slabs * 0.05));
+            dynamic_high_wm = std::max(static_cast<int>(dynamic_high_wm * shrink_factor), static_cast<int>(total_slabs * 0.6));
+        }
+
+        // move some free slabs to reserve (ENSURE RESERVE FILLS)
+        while (free_slabs.size() > dynamic_low_wm * 1.5 && reserve_slabs.size() < max_reserve) {
+            int slab = free_slabs.front();
+            free_slabs.pop_front();
+            reserve_slabs.push_back(slab);
+            //std::cout << "Moving slab to reserve: " << slab << "\n";
+        }
+
+        //use reserved slabs first if free slabs are too low
+        while (!reserve_slabs.empty() && free_slabs.size() < dynamic_low_wm) {
+            int slab = reserve_slabs.front();
+            reserve_slabs.pop_front();
+            free_slabs.push_back(slab);
+            //std::cout << "Reusing slab from reserve: " << slab << "\n";
+        }
+
+        if (free_slabs.size() < dynamic_low_wm / 2 && reserve_slabs.empty() && gc_pending == 0) {
+            //std::cout << " CRITICAL: Free & Reserve slabs too low! Triggering GC...\n";
+            gc();
+        }
+    }
+
+    bool below_low_wm() const {
+        return (int)free_slabs.size() < dynamic_low_wm;
+    }
+
+    // the free pool ran dry before the background worker caught up: take a reserve slab, or
+    // reclaim a single victim inline, so the writer waits for one slab instead of a GC round
+    bool make_room() {
+        if (!reserve_slabs.empty()) {
+            free_slabs.push_back(reserve_slabs.front());
+            reserve_slabs.pop_front();
+            return true;
+        }
+        return !migrating && reclaim_victim();
+    }
+
+    int gc_invoked_count = 0;  // global or class member variable
+    int gc_pending = 0;  // slabs left to reclaim in the running GC round
+        
+    // start a GC round, gc_step() carries it out one victim slab at a time
+    void gc() {
+        gc_invoked_count++;  
+
+        if (lru_head < 0) {
+            std::cout << "GC: No slabs available for collection.\n";
+            return;
+        }
+
+        // calculate dynamic GC threshold: free at least 50% of active slabs or gc_floor, gc_step()
+        // ends the round early once the free pool is back at the high watermark
+        int gc_threshold = std::max((int)(sealed_count * 0.50), gc_floor);
+
+        //std::cout << " GC Invocation #" << gc_invoked_count 
+                //<< ": Attempting to free " << gc_threshold << " slabs...\n";
+        gc_pending = gc_threshold;
+        if (policy != VictimPolicy::LRU) {
+            queue_victims(gc_threshold);
+        }
+    }
+
+    // reclaim one slab of the running GC round, false once the round is over
+    bool gc_step() {
+        if (gc_pending == 0 || (int)free_slabs.size() >= dynamic_high_wm || !reclaim_victim()) {
+            gc_pending = 0;
+            return false;
+        }
+        return --gc_pending > 0;
+    }
+
+    // score every sealed slab once and queue the n best as victims, so choosing the victims of
+    // a round costs one pass over the sealed slabs instead of one per victim. The scores are not
+    // updated while the queue drains, frees in a queued slab only make it a better victim
+    void queue_victims(int n) {
+        victim_scores.clear();
+        for (int id = lru_head; id >= 0; id = slab_at(id).lru_next) {
+            Slab &s = slab_at(id);
+            int valid = s.live_slots();
+            double invalid = s.num_slots - valid;
+            double score = valid == 0 ? std::numeric_limits<double>::infinity()  // nothing to lose
+                : policy == VictimPolicy::GREEDY ? invalid / s.num_slots
+                : (double)(seal_clock - s.sealed_at + 1) * invalid / valid;
+            victim_scores.emplace_back(score, id);
+        }
+        n = std::min(std::max(n, 1), (int)victim_scores.size());
+        auto better = [](const std::pair<double, int> &a, const std::pair<double, int> &b) { return a.first > b.first; };
+        std::nth_element(victim_scores.begin(), victim_scores.begin() + n, victim_scores.end(), better);
+        std::sort(victim_scores.begin(), victim_scores.begin() + n, better);
+        victims.clear();
+        for (int i = n - 1; i >= 0; i--) {
+            int id = victim_scores[i].second;
+            victims.emplace_back(id, slab_at(id).sealed_at);
+        }
+    }
+
+    // next slab to erase under the victim policy, -1 if no slab is sealed. A queued slab that
+    // was erased (and maybe sealed again) since it was scored is skipped, an empty queue is
+    // refilled with as many victims as the free pool lacks to the high watermark
+    int pick_victim() {
+        if (policy == VictimPolicy::LRU) {
+            return lru_head;
+        }
+        while (true) {
+            while (!victims.empty()) {
+                auto [id, sealed_at] = victims.back();
+                victims.pop_back();
+                if (slab_at(id).in_lru && slab_at(id).sealed_at == sealed_at) {
+                    return id;
+                }
+            }
+            if (lru_head < 0) {
+                return -1;
+            }
+            queue_victims(dynamic_high_wm - (int)free_slabs.size());
+        }
+    }
+
+    // rewrite the values of a victim that were read since they were written into open slabs, the
+    // record of a moved value is overwritten in the same batch; a moved value loses its mark and
+    // needs another read to move again. Only values of up to a block move: a hot run that starts
+    // in or continues into the victim is dropped with it like a cold value, a miss on its next read
+    void migrate_hot(int victim, rocksdb::WriteBatch &batch) {
+        std::vector<uint64_t> hot;
+        Location loc;
+        for (uint64_t fp : owners[victim - first_slab]) {
+            if (maps_into(fp, victim, loc) && loc.hot && loc.blocks == 1) {
+                hot.push_back(fp);
+            }
+        }
+
+        migrating = true;  // no nested reclaim while allocating for the moved values
+        std::string key, val;
+        for (uint64_t fp : hot) {
+            MappingIndex::Entry *e = index.find(fp);
+            if (!e) {
+                continue;
+            }
+            loc = unpack_location(e->loc);
+            if (loc.slab != victim || !db->get_at(block_key(loc), &key, &val)) {
+                continue;
+            }
+            int cls = size_class(val.size());
+            int chan = pick_channel(cls);
+            if (chan < 0) {
+                break;
+            }
+            Location moved = alloc_run(cls, chan, 1);
+            if (moved.slab < 0) {
+                break;
+            }
+            db->stage(batch, block_key(moved), key, val);
+            stage_mapping(batch, fp, moved, val.size());
+            dram.put(moved, key, val);
+            release(loc);
+            map_entry(fp, moved);
+        }
+        migrating = false;
+    }
+
+    // erase the policy's victim slab and return it to the free pool, false if none is left
+    bool reclaim_victim() {
+        int victim = pick_victim();
+        if (victim < 0) {
+            return false;
+        }
+        lru_unlink(victim);
+        sealed_count--;
+        rocksdb::WriteBatch batch;
+        if (migrate) {
+            migrate_hot(victim, batch);
+        }
+        unmap_slab(victim, batch);
+        db->write(batch);  // before the victim is erased, so recovery never maps an erased value
+        Slab *s = &slab_at(victim);
+
+        // the keys of a slab are one contiguous range
+        db->delete_range(block_key(victim, 0), block_key(victim + 1, 0));
+        dram.erase_slab(victim);
+        s->reset();
+
+        free_slabs.push_back(victim);
+        return true;
+    }
+
+public:
+    // owns slabs [first_slab, first_slab + num_slabs)
+    CacheShard(RocksDBWrapper *db, int first_slab, int num_slabs, const CacheOptions &opts)
+        : db(db), NUM_CHANNELS(opts.num_channels), max_reserve_ratio(opts.max_reserve_ratio), total_slabs(num_slabs),
+          gc_floor(std::min(opts.gc_floor / opts.num_shards, num_slabs)), first_slab(first_slab),
+          map_prefix(block_key(first_slab, 0).substr(0, SLAB_PREFIX_LEN)), policy(opts.policy), migrate(opts.migrate),
+          dram(opts.dram_bytes / opts.num_shards) {
+        if (opts.admission) {
+            admission = std::make_unique<TinyLFU>((size_t)num_slabs * BLOCKS_PER_SLAB);
+        }
+        slabs.reserve(num_slabs);
+        owners.resize(num_slabs);
+        for (int i = first_slab; i < first_slab + num_slabs; i++) {
+            slabs.emplace_back(i, i % NUM_CHANNELS);  // the column family RocksDBWrapper::channel_of picks
+            free_slabs.push_back(i);
+        }
+        open_slabs.assign(NUM_CLASSES, std::vector<int>(NUM_CHANNELS, -1));
+        dynamic_low_wm = total_slabs * opts.low_wm_ratio;
+        dynamic_high_wm = total_slabs * opts.high_wm_ratio;
+        manage_op();
+    }
+
+    // warm restart: rebuild the mapping and slab table from this shard's mapping records. Slabs
+    // holding a mapped value come back sealed (the unwritten tail of a slab that was open waits
+    // for GC), the others return to the free pool. A record that does not fit the slab layout
+    // is skipped, its value is lost like any other cache miss
+    void recover(rocksdb::Iterator *it) {
+        std::vector<int> cls_of(total_slabs, -1);  // size class a slab was formatted for, -1 if unused
+        Location loc;
+        int length;
+        std::vector<int> chain;
+        for (it->Seek(map_prefix); it->Valid() && it->key().starts_with(map_prefix); it->Next()) {
+            if (it->key().size() != map_prefix.size() + 8 || !decode_location(it->value(), loc, length, chain)) {
+                continue;
+            }
+            int cls = size_class(length);
+            loc.blocks = slots_needed(length, cls);
+            chain.insert(chain.begin(), loc.slab);
+            bool fits = length >= 0 && loc.blocks <= MAX_RUN_BLOCKS && loc.block >= 0 && loc.block < BLOCKS_PER_SLAB && loc.offset >= 0;
+            for (int id : chain) {
+                fits = fits && id >= first_slab && id < first_slab + total_slabs &&
+                       (cls_of[id - first_slab] < 0 || cls_of[id - first_slab] == cls);
+            }
+            if (!fits) {
+                continue;
+            }
+            for (size_t i = 0; i < chain.size(); i++) {
+                if (cls_of[chain[i] - first_slab] < 0) {
+                    cls_of[chain[i] - first_slab] = cls;
+                    slab_at(chain[i]).format(SIZE_CLASSES[cls]);
+                }
+                if (i > 0) {
+                    slab_at(chain[i - 1]).next = chain[i];
+                }
+            }
+            if (loc.blocks == 1) {
+                slab_at(loc.slab).mark(slot_of(loc));
+            } else {
+                for (auto &[slab, block] : run_blocks(loc)) {
+                    slab_at(slab).mark(block);
+                }
+            }
+            loc.epoch = slab_at(loc.slab).epoch;
+            map_entry(fingerprint_at(it->key().data() + map_prefix.size()), loc);
+        }
+
+        free_slabs.clear();
+        reserve_slabs.clear();
+        for (int id = first_slab; id < first_slab + total_slabs; id++) {
+            if (cls_of[id - first_slab] < 0) {
+                free_slabs.push_back(id);
+                continue;
+            }
+            Slab &s = slab_at(id);
+            s.next_slot = s.num_slots;
+            s.sealed_at = ++seal_clock;
+            sealed_count++;
+            lru_push(id);
+        }
+        manage_op();
+    }
+
+    int admitted_count = 0, rejected_count = 0;
+
+    // new keys pass the admission filter once flash is half full, updates of cached keys always do
+    bool admit(const std::string &key, uint64_t fp) {
+        if (!admission || index.find(fp) || sealed_count < total_slabs / 2) {
+            return true;
+        }
+        bool ok = admission->admit(key);
+        if (ok) {
+            admitted_count++;
+        } else {
+            rejected_count++;
+        }
+        return ok;
+    }
+
+    void put(const std::string &key, const rocksdb::Slice &val) {
+        uint64_t fp = key_fingerprint(key);
+        if (!admit(key, fp)) {
+            return;
+        }
+        // round-robin over channels, appending to each channel's open slab of the value's size class
+        int cls = size_class(val.size());
+        int num_slots = slots_needed(val.size(), cls);
+        int chan = pick_channel(cls);
+        Location loc = chan < 0 || num_slots > MAX_RUN_BLOCKS ? Location() : alloc_run(cls, chan, num_slots);
+        if (loc.slab < 0) {
+            del(key);  // a failed overwrite must not leave the old value readable
+            return;
+        }
+        // the old value is released only once the new one has its slots
+        if (MappingIndex::Entry *old = index.find(fp)) {
+            release(unpack_location(old->loc));
+        }
+        rocksdb::WriteBatch batch(batch_bytes(key.size() + val.size()) + batch_bytes(LOCATION_RECORD_LEN));
+        if (num_slots == 1) {
+            db->stage(batch, block_key(loc), key, val);
+            dram.put(loc, key, val);
+        } else {
+            db->stage(batch, block_keys(loc), key, val);
+        }
+        stage_mapping(batch, fp, loc, val.size());
+        db->write(batch);
+        map_entry(fp, loc);
+    }
+
+    // allocate and map the pairs at positions idx, staging each value and its mapping record
+    // into batches[channel of its first slab]
+    void stage_batch(const std::vector<std::pair<std::string, rocksdb::Slice>>& kv_pairs,
+                     const std::vector<size_t> &idx, std::vector<rocksdb::WriteBatch> &batches) {
+        // single-slot values of a size class share one allocator call, runs allocate on their own;
+        // the scratch vectors are shard members so a steady stream of batches reuses them
+        std::vector<Location> &locs = batch_locs;
+        locs.assign(idx.size(), Location());
+        for (auto &members : by_class) {
+            members.clear();
+        }
+        std::vector<uint64_t> &fps = batch_fps;
+        fps.resize(idx.size());
+        int run_chan = -1;
+        for (size_t j = 0; j < idx.size(); j++) {
+            fps[j] = key_fingerprint(kv_pairs[idx[j]].first);
+            if (!admit(kv_pairs[idx[j]].first, fps[j])) {
+                continue;
+            }
+            const rocksdb::Slice &val = kv_pairs[idx[j]].second;
+            int cls = size_class(val.size());
+            int num_slots = slots_needed(val.size(), cls);
+            if (num_slots == 1) {
+                by_class[cls].push_back(j);
+                continue;
+            }
+            // consecutive runs stay in one channel's slabs, as consecutive slots do in alloc_slots,
+            // so a chain of KV pages written in one batch is read back sequentially
+            int chan = run_chan >= 0 && open_slabs[cls][run_chan] >= 0 ? run_chan : pick_channel(cls);
+            if (chan >= 0 && num_slots <= MAX_RUN_BLOCKS) {
+                locs[j] = alloc_run(cls, chan, num_slots);
+                run_chan = chan;
+            }
+        }
+        for (int cls = 0; cls < NUM_CLASSES; cls++) {
+            alloc_slots(cls, by_class[cls], locs);
+        }
+
+        for (size_t j = 0; j < idx.size(); j++) {
+            const auto &[key, val] = kv_pairs[idx[j]];
+            if (locs[j].slab < 0) {
+                del(key);  // out of space, dropped like a failed put
+                continue;
+            }
+            if (MappingIndex::Entry *old = index.find(fps[j])) {
+                release(unpack_location(old->loc));
+            }
+            rocksdb::WriteBatch &batch = batches[slab_at(locs[j].slab).channel];
+            if (locs[j].blocks == 1) {
+                db->stage(batch, block_key(locs[j]), key, val);
+                dram.put(locs[j], key, val);
+            } else {
+                db->stage(batch, block_keys(locs[j]), key, val);
+            }
+            stage_mapping(batch, fps[j], locs[j], val.size());
+            map_entry(fps[j], locs[j]);
+        }
+    }
+
+    int hit_count = 0, miss_count = 0;
+
+    // value of key in val: a flash block stays pinned without a copy, a DRAM hit or a run is
+    // copied into val's own buffer, which keeps its capacity when the caller reuses val
+    bool read(const std::string &key, rocksdb::PinnableSlice *val) {
+        val->Reset();
+        if (admission) {
+            admission->record(key);
+        }
+        MappingIndex::Entry *e = index.find(key_fingerprint(key));
+        Location loc;
+        if (!e || !current(loc = unpack_location(e->loc))) {
+            miss_count++;
+            return false;
+        }
+        e->loc |= HOT_BIT;
+        touch(loc.slab);
+        bool found;
+        if (loc.blocks == 1) {
+            if (const std::string *cached = dram.get(loc, key)) {
+                val->PinSelf(*cached);
+                found = true;
+            } else {
+                found = db->get(value_key(loc, key), val);
+                if (found) {
+                    dram.put(loc, key, *val);
+                }
+            }
+        } else {
+            for (auto &[slab, block] : run_blocks(loc)) {
+                if (block == 0 && slab != loc.slab) {
+                    touch(slab);
+                }
+            }
+            found = db->get_run(value_keys(loc, key), val->GetSelf());
+            if (found) {
+                val->PinSelf();
+            }
+        }
+        // a mapping whose blocks GC already erased, or another key with the same fingerprint, is a miss
+        if (found) {
+            hit_count++;
+        } else {
+            miss_count++;
+        }
+        return found;
+    }
+
+    std::string get(const std::string &key) {
+        static thread_local rocksdb::PinnableSlice val;
+        std::string copy = read(key, &val) ? val.ToString() : "";
+        val.Reset();
+        return copy;
+    }
+
+    // values of the keys at positions idx that the DRAM tier holds into results, block keys of
+    // the others into value_blocks, touching every slab once
+    void locate(const std::vector<std::string> &keys, const std::vector<size_t> &idx,
+                std::vector<std::vector<std::string>> &value_blocks, std::vector<std::string> &results) {
+        std::unordered_set<int> touched;
+        for (size_t i : idx) {
+            if (admission) {
+                admission->record(keys[i]);
+            }
+            MappingIndex::Entry *e = index.find(key_fingerprint(keys[i]));
+            Location loc;
+            if (!e || !current(loc = unpack_location(e->loc))) {
+                continue;
+            }
+            e->loc |= HOT_BIT;
+            if (const std::string *cached = loc.blocks == 1 ? dram.get(loc, keys[i]) : nullptr) {
+                results[i] = *cached;
+            } else {
+                value_blocks[i] = value_keys(loc, keys[i]);
+            }
+            for (auto &[slab, block] : run_blocks(loc)) {
+                touched.insert(slab);
+            }
+        }
+        for (auto &slab : touched) {
+            touch(slab);
+        }
+    }
+
+    // number of leading keys mapped to a live location, an index probe only
+    size_t mapped_prefix(const std::vector<std::string> &keys) {
+        size_t n = 0;
+        for (; n < keys.size(); n++) {
+            MappingIndex::Entry *e = index.find(key_fingerprint(keys[n]));
+            if (!e || !current(unpack_location(e->loc))) {
+                break;
+            }
+        }
+        return n;
+    }
+
+    // block keys a prefetch of the keys at positions idx should read into value_blocks, with the
+    // packed location they were planned for in locs: mapped keys, except single-block values the
+    // DRAM tier already holds. A hint is not a read, nothing is marked hot, touched or counted
+    void plan_prefetch(const std::vector<std::string> &keys, const std::vector<size_t> &idx,
+                       std::vector<std::vector<std::string>> &value_blocks, std::vector<uint64_t> &locs) {
+        for (size_t i : idx) {
+            MappingIndex::Entry *e = index.find(key_fingerprint(keys[i]));
+            Location loc;
+            if (!e || !current(loc = unpack_location(e->loc)) || (loc.blocks == 1 && dram.contains(loc))) {
+                continue;
+            }
+            value_blocks[i] = value_keys(loc, keys[i]);
+            locs[i] = e->loc & ~HOT_BIT;
+        }
+    }
+
+    // keep a prefetched value in the DRAM tier, unless the key moved since the prefetch was planned
+    void fill_prefetched(const std::string &key, uint64_t planned, const std::string &val) {
+        MappingIndex::Entry *e = index.find(key_fingerprint(key));
+        if (e && (e->loc & ~HOT_BIT) == planned) {
+            dram.put(unpack_location(planned), key, val, true);
+        }
+    }
+
+    // keep a value read from flash in the DRAM tier
+    void fill(const std::string &key, const std::string &val) {
+        if (MappingIndex::Entry *e = index.find(key_fingerprint(key))) {
+            Location loc = unpack_location(e->loc);
+            if (loc.blocks == 1) {
+                dram.put(loc, key, val);
+            }
+        }
+    }
+
+    void del(const std::string &key) {
+        uint64_t fp = key_fingerprint(key);
+        if (MappingIndex::Entry *e = index.find(fp)) {
+            Location loc = unpack_location(e->loc);
+
+            // Free the allocated slots
+            release(loc);
+
+            // Delete from RocksDB, the mapping record and every block of the value in one atomic
+            // write, so a crash never leaves a mapped value with some of its blocks gone
+            rocksdb::WriteBatch batch;
+            db->stage_unmap(batch, map_prefix, fp);
+            for (auto &block : value_keys(loc, key)) {
+                db->stage_del(batch, block);
+            }
+            db->write(batch);
+
+            // Remove from the index
+            index.erase(fp);
+        }
+    }
+};
+
+// partitions keys by hash over independent shards so threads working on different
+// keys rarely wait for each other, the RocksDB instance is shared and thread-safe
+class KeyValueCache {
+    std::unique_ptr<RocksDBWrapper> db;
+    std::vector<std::unique_ptr<CacheShard>> shards;
+
+    // background GC and over-provisioning, woken by writers that leave a shard below its
+    // low watermark and otherwise every OP_INTERVAL
+    const std::chrono::milliseconds OP_INTERVAL{100};
+    std::thread op_thread;
+    std::mutex op_mu;
+    std::condition_variable op_cv;
+    bool stopping = false;
+
+    // runs the async API, declared after the shards so that it drains its queue before they go
+    std::unique_ptr<IoPool> io_pool;
+
+    // run f on the I/O pool, its result or exception goes to the returned future
+    template <typename F>
+    auto run_async(F f) -> std::future<decltype(f())> {
+        // std::function needs a copyable job, the task is shared with it
+        auto task = std::make_shared<std::packaged_task<decltype(f())()>>(std::move(f));
+        std::future<decltype(f())> result = task->get_future();
+        io_pool->submit([task] { (*task)(); });
+        return result;
+    }
+
+    // prefetch job: plan under each shard's lock, read with the shards unlocked so foreground
+    // requests go first, then fill the DRAM tier with the single-block values
+    void read_ahead(const std::vector<std::string> &keys) {
+        std::vector<std::vector<size_t>> by_shard(shards.size());
+        for (size_t i = 0; i < keys.size(); i++) {
+            by_shard[shard_index(keys[i])].push_back(i);
+        }
+        std::vector<std::vector<std::string>> value_blocks(keys.size());
+        std::vector<uint64_t> locs(keys.size());
+        for (size_t s = 0; s < shards.size(); s++) {
+            if (!by_shard[s].empty()) {
+                std::lock_guard<std::mutex> lock(shards[s]->mu);
+                shards[s]->plan_prefetch(keys, by_shard[s], value_blocks, locs);
+            }
+        }
+
+        std::vector<std::pair<std::string, size_t>> blocks;  // block key -> key index
+        for (size_t i = 0; i < keys.size(); i++) {
+            for (auto &block : value_blocks[i]) {
+                blocks.push_back({block, i});
+            }
+        }
+        if (blocks.empty()) {
+            return;
+        }
+        std::sort(blocks.begin(), blocks.end());
+        std::vector<std::string> block_keys;
+        block_keys.reserve(blocks.size());
+        for (auto &b : blocks) {
+            block_keys.push_back(b.first);
+        }
+        std::vector<bool> found;
+        std::vector<std::string> vals = db->multi_get(block_keys, found, true);  // also fills the block cache
+
+        for (size_t j = 0; j < blocks.size(); j++) {
+            size_t i = blocks[j].second;
+            if (found[j] && value_blocks[i].size() == 1) {
+                CacheShard &shard = shard_of(keys[i]);
+                std::lock_guard<std::mutex> lock(shard.mu);
+                shard.fill_prefetched(keys[i], locs[i], vals[j]);
+            }
+        }
+    }
+
+    size_t shard_index(const std::string &key) const {
+        return route_hash(key) % shards.size();
+    }
+
+    CacheShard &shard_of(const std::string &key) {
+        return *shards[shard_index(key)];
+    }
+
+    // one pass of OP balancing over all shards, a GC round is carried out one victim
+    // slab per lock hold so foreground requests on the shard get in between
+    void op_round() {
+        for (auto &shard : shards) {
+            {
+                std::lock_guard<std::mutex> lock(shard->mu);
+                shard->manage_op();
+            }
+            bool more = true;
+            while (more) {
+                std::lock_guard<std::mutex> lock(shard->mu);
+                more = shard->gc_step();
+            }
+        }
+    }
+
+    void op_worker() {
+        std::unique_lock<std::mutex> lock(op_mu);
+        while (!stopping) {
+            op_cv.wait_for(lock, OP_INTERVAL);
+            if (stopping) {
+                break;
+            }
+            lock.unlock();
+            db->sync_wal();  // group commit of the writes since the last wakeup
+            op_round();
+            lock.lock();
+        }
+    }
+
+    // rebuild every shard from its range of the mapping column family, one thread per shard.
+    // Slab ranges follow the shard count and slab channels the channel count, so a mapping
+    // written with other counts, or in an older record format, is dropped
+    void recover(int num_shards, int total_slabs, int num_channels) {
+        std::string layout = MAPPING_FORMAT + std::to_string(num_shards) + "x" + std::to_string(total_slabs / num_shards) +
+                             "x" + std::to_string(num_channels);
+        std::string stored = db->layout();
+        if (stored != layout) {
+            if (!stored.empty()) {
+                std::cerr << "Mapping layout " << stored << " does not match " << layout << ", starting empty" << std::endl;
+            }
+            db->clear();
+            db->set_layout(layout);
+            return;
+        }
+        std::vector<std::thread> workers;
+        for (auto &shard : shards) {
+            workers.emplace_back([this, &shard] { shard->recover(db->scan_mapping().get()); });
+        }
+        for (auto &worker : workers) {
+            worker.join();
+        }
+    }
+
+public:
+    explicit KeyValueCache(const std::string &db_path, const CacheOptions &opts = CacheOptions())
+        : db(std::make_unique<RocksDBWrapper>(db_path, opts)) {
+        int per_shard = opts.total_slabs / opts.num_shards;
+        for (int i = 0; i < opts.num_shards; i++) {
+            shards.push_back(std::make_unique<CacheShard>(db.get(), i * per_shard, per_shard, opts));
+        }
+        recover(opts.num_shards, opts.total_slabs, opts.num_channels);
+        op_thread = std::thread(&KeyValueCache::op_worker, this);
+        io_pool = std::make_unique<IoPool>(opts.io_threads, opts.io_queue_depth);
+    }
+
+    ~KeyValueCache() {
+        {
+            std::lock_guard<std::mutex> lock(op_mu);
+            stopping = true;
+        }
+        op_cv.notify_one();
+        op_thread.join();
+    }
+
+    // run a full OP / GC pass now instead of waiting for the background worker
+    void trigger_gc_op() {
+        op_round();
+    }
+
+    size_t flash_bytes_written() const {
+        return db->bytes_written;
+    }
+
+    void put(const std::string &key, const rocksdb::Slice &val) {
+        CacheShard &shard = shard_of(key);
+        std::unique_lock<std::mutex> lock(shard.mu);
+        shard.put(key, val);
+        bool low = shard.below_low_wm();
+        lock.unlock();
+        if (low) {
+            op_cv.notify_one();
+        }
+    }
+
+    std::string get(const std::string &key) {
+        CacheShard &shard = shard_of(key);
+        std::lock_guard<std::mutex> lock(shard.mu);
+        return shard.get(key);
+    }
+
+    // zero-copy read: the value stays valid until out is reset or reused, and a caller that
+    // keeps one PinnableSlice across reads allocates nothing once its buffer has grown
+    bool get(const std::string &key, rocksdb::PinnableSlice *out) {
+        CacheShard &shard = shard_of(key);
+        std::lock_guard<std::mutex> lock(shard.mu);
+        return shard.read(key, out);
+    }
+
+    // read into a caller buffer: returns the value length, 0 on a miss, and copies only when
+    // the value fits in cap so the caller can retry with a larger buffer
+    size_t get(const std::string &key, char *buf, size_t cap) {
+        static thread_local rocksdb::PinnableSlice val;
+        if (!get(key, &val)) {
+            return 0;
+        }
+        size_t len = val.size();
+        if (len <= cap) {
+            memcpy(buf, val.data(), len);
+        }
+        val.Reset();
+        return len;
+    }
+
+    // shards touched by the batch are locked in index order, so concurrent batches cannot deadlock;
+    // values are copied once, from the caller's buffers into one WriteBatch per channel, and the
+    // channels are written in parallel. The batches are reused, so they keep their capacity, up
+    // to MAX_KEPT_BATCH_BYTES each: a batch of large values (KV pages) frees its buffer once written.
+    // A key given twice keeps its last value: the channel batches commit in any order, so two
+    // mapping records of one key must never be staged into different ones
+    void batch_put(const std::vector<std::pair<std::string, rocksdb::Slice>>& kv_pairs) {
+        const size_t MAX_KEPT_BATCH_BYTES = 4 << 20;
+        static thread_local std::vector<std::vector<size_t>> by_shard;
+        static thread_local std::vector<std::unique_lock<std::mutex>> locks;
+        static thread_local std::vector<rocksdb::WriteBatch> batches;
+        static thread_local std::vector<size_t> order;
+        static thread_local std::vector<bool> superseded;
+        by_shard.resize(shards.size());
+        for (auto &idx : by_shard) {
+            idx.clear();
+        }
+        batches.resize(db->num_channels());
+        for (auto &batch : batches) {
+            batch.Clear();
+        }
+
+        // sort positions by (key, position), so each duplicate sits right before a later copy
+        order.resize(kv_pairs.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            int c = kv_pairs[a].first.compare(kv_pairs[b].first);
+            return c < 0 || (c == 0 && a < b);
+        });
+        superseded.assign(kv_pairs.size(), false);
+        for (size_t k = 1; k < order.size(); k++) {
+            if (kv_pairs[order[k]].first == kv_pairs[order[k - 1]].first) {
+                superseded[order[k - 1]] = true;
+            }
+        }
+        for (size_t i = 0; i < kv_pairs.size(); i++) {
+            if (!superseded[i]) {
+                by_shard[shard_index(kv_pairs[i].first)].push_back(i);
+            }
+        }
+        bool low = false;
+        for (size_t s = 0; s < shards.size(); s++) {
+            if (by_shard[s].empty()) {
+                continue;
+            }
+            locks.emplace_back(shards[s]->mu);
+            shards[s]->stage_batch(kv_pairs, by_shard[s], batches);
+            low = low || shards[s]->below_low_wm();
+        }
+        db->write(batches);
+        locks.clear();
+        for (auto &batch : batches) {
+            if (batch.GetDataSize() > MAX_KEPT_BATCH_BYTES) {
+                batch = rocksdb::WriteBatch();
+            }
+        }
+        if (low) {
+            op_cv.notify_one();
+        }
+    }
+
+    void batch_put(const std::vector<std::pair<std::string, std::string>>& kv_pairs) {
+        batch_put(std::vector<std::pair<std::string, rocksdb::Slice>>(kv_pairs.begin(), kv_pairs.end()));
+    }
+
+    // values of many keys with one MultiGet per channel in block key order and one LRU update
+    // per touched slab, a key that is not cached (or lost a block to GC) comes back empty
+    std::vector<std::string> multi_get(const std::vector<std::string> &keys) {
+        std::vector<std::vector<size_t>> by_shard(shards.size());
+        for (size_t i = 0; i < keys.size(); i++) {
+            by_shard[shard_index(keys[i])].push_back(i);
+        }
+        std::vector<std::vector<std::string>> value_blocks(keys.size());
+        std::vector<std::string> results(keys.size());
+        std::vector<std::unique_lock<std::mutex>> locks;
+        for (size_t s = 0; s < shards.size(); s++) {
+            if (by_shard[s].empty()) {
+                continue;
+            }
+            locks.emplace_back(shards[s]->mu);
+            shards[s]->locate(keys, by_shard[s], value_blocks, results);
+        }
+
+        std::vector<std::pair<std::string, std::pair<size_t, int>>> blocks;  // block key -> (key index, piece)
+        std::vector<int> pieces(keys.size(), 0);
+        for (size_t i = 0; i < keys.size(); i++) {
+            for (auto &block : value_blocks[i]) {
+                blocks.push_back({block, {i, pieces[i]++}});
+            }
+        }
+
+        std::sort(blocks.begin(), blocks.end());
+        std::vector<std::string> block_keys;
+        block_keys.reserve(blocks.size());
+        for (auto &b : blocks) {
+            block_keys.push_back(b.first);
+        }
+        std::vector<bool> found;
+        std::vector<std::string> vals = db->multi_get(block_keys, found, true);
+
+        std::vector<std::vector<std::string>> parts(keys.size());
+        std::vector<bool> complete(keys.size(), true);
+        for (size_t i = 0; i < keys.size(); i++) {
+            parts[i].resize(pieces[i]);
+        }
+        for (size_t j = 0; j < blocks.size(); j++) {
+            auto [i, piece] = blocks[j].second;
+            if (!found[j]) {
+                complete[i] = false;
+            } else {
+                parts[i][piece] = std::move(vals[j]);
+            }
+        }
+
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (pieces[i] == 0 || !complete[i]) {
+                continue;
+            }
+            if (pieces[i] == 1) {
+                results[i] = std::move(parts[i][0]);
+                shards[shard_index(keys[i])]->fill(keys[i], results[i]);
+                continue;
+            }
+            for (auto &part : parts[i]) {
+                results[i] += part;
+            }
+        }
+
+        // counted like get, under the shard locks still held: a DRAM or complete flash read is a
+        // hit, an unmapped key or a value that lost a block to GC a miss
+        for (size_t i = 0; i < keys.size(); i++) {
+            CacheShard &shard = *shards[shard_index(keys[i])];
+            if (results[i].empty()) {
+                shard.miss_count++;
+            } else {
+                shard.hit_count++;
+            }
+        }
+        return results;
+    }
+
+    // async API for callers that overlap cache I/O with their own work, e.g. an inference scheduler
+    // fetching the pages of the next request while the GPU runs the current one. Requests run on
+    // the I/O pool, so many reads are in flight at once; keys and values are copied into the request
+    std::future<std::string> async_get(std::string key) {
+        return run_async([this, key = std::move(key)] { return get(key); });
+    }
+
+    std::future<void> async_put(std::string key, std::string val) {
+        return run_async([this, key = std::move(key), val = std::move(val)] { put(key, val); });
+    }
+
+    std::future<std::vector<std::string>> async_multi_get(std::vector<std::string> keys) {
+        return run_async([this, keys = std::move(keys)] { return multi_get(keys); });
+    }
+
+    // read-ahead hint: a pool worker reads the values of keys in the background, so a later get of
+    // a single-block value is a DRAM hit and a larger one finds its blocks in the RocksDB block
+    // cache. Prefetched values that are never read are the first to leave the DRAM tier. Keys that
+    // are not cached are skipped, and the whole hint is dropped when the I/O queue is full
+    void prefetch(std::vector<std::string> keys) {
+        io_pool->try_submit([this, keys = std::move(keys)] { read_ahead(keys); });
+    }
+
+    // hint for the pages of a prompt prefix, e.g. the next decode steps of a request
+    void will_need(const PageScope &scope, const std::vector<uint64_t> &block_hashes) {
+        prefetch(page_keys(scope, block_hashes, block_hashes.size()));
+    }
+
+    // store the KV pages of token blocks [first, first + pages.size()) of a prompt, typically the
+    // blocks past its longest cached prefix. The chain's pages go to one shard in one batch, so
+    // they take consecutive slots of the same open slabs
+    void put_pages(const PageScope &scope, const std::vector<uint64_t> &block_hashes,
+                   const std::vector<rocksdb::Slice> &pages, size_t first = 0) {
+        std::vector<std::string> keys = page_keys(scope, block_hashes, first + pages.size());
+        std::vector<std::pair<std::string, rocksdb::Slice>> kv_pairs;
+        kv_pairs.reserve(pages.size());
+        for (size_t i = first; i < keys.size(); i++) {
+            kv_pairs.emplace_back(std::move(keys[i]), pages[i - first]);
+        }
+        batch_put(kv_pairs);
+    }
+
+    // how many leading token blocks have their page cached, probing the chain's shard index under
+    // one lock hold. Nothing is read from flash: a page lost to a fingerprint collision only shows
+    // up as a miss in get_pages
+    size_t longest_cached_prefix(const PageScope &scope, const std::vector<uint64_t> &block_hashes) {
+        std::vector<std::string> keys = page_keys(scope, block_hashes, block_hashes.size());
+        if (keys.empty()) {
+            return 0;
+        }
+        CacheShard &shard = shard_of(keys[0]);
+        std::lock_guard<std::mutex> lock(shard.mu);
+        return shard.mapped_prefix(keys);
+    }
+
+    // pages of the first n token blocks with one multi_get, which reads the chain's slabs in block
+    // order; a page that is not cached comes back empty
+    std::vector<std::string> get_pages(const PageScope &scope, const std::vector<uint64_t> &block_hashes, size_t n) {
+        return multi_get(page_keys(scope, block_hashes, n));
+    }
+
+    void del(const std::string &key) {
+        CacheShard &shard = shard_of(key);
+        std::lock_guard<std::mutex> lock(shard.mu);
+        shard.del(key);
+    }
+
+    size_t mapped_keys() const {
+        size_t n = 0;
+        for (auto &shard : shards) {
+            std::lock_guard<std::mutex> lock(shard->mu);
+            n += shard->index.size();
+        }
+        return n;
+    }
+
+    // DRAM held by the mapping indexes
+    size_t index_bytes() const {
+        size_t n = 0;
+        for (auto &shard : shards) {
+            std::lock_guard<std::mutex> lock(shard->mu);
+            n += shard->index.bytes();
+        }
+        return n;
+    }
+
+    void print_hit_ratio() const {
+        int hit_count = 0, miss_count = 0, admitted_count = 0, rejected_count = 0;
+        int prefetched_count = 0, prefetch_hits = 0;
+        for (auto &shard : shards) {
+            std::lock_guard<std::mutex> lock(shard->mu);
+            hit_count += shard->hit_count;
+            miss_count += shard->miss_count;
+            admitted_count += shard->admitted_count;
+            rejected_count += shard->rejected_count;
+            prefetched_count += shard->dram.prefetched_count;
+            prefetch_hits += shard->dram.prefetch_hits;
+        }
+        int total = hit_count + miss_count;
+        if (total == 0) return;
+        std::cout << "Cache Hit Ratio: " << (hit_count * 100.0 / total) << "%\n";
+        if (admitted_count + rejected_count > 0) {
+            std::cout << "Admitted new keys: " << admitted_count
+                      << " | Rejected new keys: " << rejected_count << "\n";
+        }
+        if (prefetched_count > 0) {
+            std::cout << "Prefetched values: " << prefetched_count
+                      << " | Read after prefetch: " << prefetch_hits << "\n";
+        }
+    }
+    void print_stats() const {
+        size_t free_count = 0, active_count = 0, reserve_count = 0;
+        for (auto &shard : shards) {
+            std::lock_guard<std::mutex> lock(shard->mu);
+            free_count += shard->free_slabs.size();
+            active_count += shard->sealed_count;
+            reserve_count += shard->reserve_slabs.size();
+        }
+        std::cout << "Free slabs: " << free_count
+                  << " | Active slabs: " << active_count
+                  << " | Reserved slabs: " << reserve_count << "\n";
+    }
+};